@@ -0,0 +1,314 @@
+// Benchmark de compresion y descompresion sobre un corpus reproducible.
+//
+// Uso: huffman_bench [--format csv|json] [--sizes N,N,...] [--iterations N]
+//                    [--threads N] [--text ruta]
+//
+// Para cada corpus, tamanio y numero de flujos mide (mejor de N repeticiones)
+// MB/s, ciclos por byte (contador de tiempo del procesador, si existe),
+// ratio y pico de memoria del heap durante la operacion.
+
+#include "huffman.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define HUFFMAN_BENCH_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HUFFMAN_BENCH_TSC 1
+#endif
+
+#ifndef HUFFMAN_SOURCE_DIR
+#define HUFFMAN_SOURCE_DIR "."
+#endif
+
+// ---------------------------------------------------------------------------
+// Medicion del heap: operator new/delete contados. Cada bloque guarda su
+// tamanio en una cabecera de 16 bytes (conserva la alineacion de malloc).
+
+static std::atomic<size_t> heapCurrent{0};
+static std::atomic<size_t> heapPeak{0};
+
+static void* countedAlloc(size_t size) {
+    void* raw = std::malloc(size + 16);
+    if (!raw) throw std::bad_alloc();
+    *static_cast<size_t*>(raw) = size;
+    size_t now = heapCurrent.fetch_add(size) + size;
+    size_t peak = heapPeak.load();
+    while (now > peak && !heapPeak.compare_exchange_weak(peak, now)) {
+    }
+    return static_cast<char*>(raw) + 16;
+}
+
+static void countedFree(void* ptr) {
+    if (!ptr) return;
+    void* raw = static_cast<char*>(ptr) - 16;
+    heapCurrent.fetch_sub(*static_cast<size_t*>(raw));
+    std::free(raw);
+}
+
+void* operator new(size_t size) { return countedAlloc(size); }
+void* operator new[](size_t size) { return countedAlloc(size); }
+void operator delete(void* ptr) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr) noexcept { countedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { countedFree(ptr); }
+
+// ---------------------------------------------------------------------------
+// Corpus. Generador propio (splitmix64) para que los datos sean identicos en
+// cualquier compilador y biblioteca estandar.
+
+struct SplitMix64 {
+    uint64_t state;
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    double uniform() { return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0); }
+};
+
+static std::vector<uint8_t> makeUniform(size_t size) {
+    SplitMix64 rng{1};
+    std::vector<uint8_t> data(size);
+    for (uint8_t& byte : data) byte = static_cast<uint8_t>(rng.next());
+    return data;
+}
+
+// 256 simbolos con probabilidad proporcional a 1 / rango^1.2
+static std::vector<uint8_t> makeZipf(size_t size) {
+    std::vector<double> cdf(256);
+    double total = 0;
+    for (int i = 0; i < 256; ++i) {
+        total += 1.0 / std::pow(i + 1, 1.2);
+        cdf[i] = total;
+    }
+    SplitMix64 rng{2};
+    std::vector<uint8_t> data(size);
+    for (uint8_t& byte : data) {
+        double u = rng.uniform() * total;
+        byte = static_cast<uint8_t>(std::min<size_t>(std::upper_bound(cdf.begin(), cdf.end(), u) - cdf.begin(), 255));
+    }
+    return data;
+}
+
+static std::vector<uint8_t> makeSingle(size_t size) {
+    return std::vector<uint8_t>(size, 'a');
+}
+
+// Registros binarios de 16 bytes: id creciente, categoria chica, relleno,
+// una medicion float que varia lentamente y un contador de baja entropia
+static std::vector<uint8_t> makeBinary(size_t size) {
+    SplitMix64 rng{3};
+    std::vector<uint8_t> data(size);
+    float value = 100.0f;
+    uint32_t counter = 0;
+    for (size_t offset = 0, id = 0; offset < size; offset += 16, ++id) {
+        uint64_t random = rng.next();
+        value += static_cast<float>(static_cast<int>(random & 0xFF) - 128) * 0.01f;
+        counter += static_cast<uint32_t>((random >> 8) & 0x3);
+        uint32_t bits;
+        std::memcpy(&bits, &value, 4);
+        uint8_t record[16] = {
+            static_cast<uint8_t>(id), static_cast<uint8_t>(id >> 8),
+            static_cast<uint8_t>(id >> 16), static_cast<uint8_t>(id >> 24),
+            static_cast<uint8_t>((random >> 16) & 0x0F), 0, 0, 0,
+            static_cast<uint8_t>(bits), static_cast<uint8_t>(bits >> 8),
+            static_cast<uint8_t>(bits >> 16), static_cast<uint8_t>(bits >> 24),
+            static_cast<uint8_t>(counter), static_cast<uint8_t>(counter >> 8), 0, 0
+        };
+        std::memcpy(data.data() + offset, record, std::min<size_t>(16, size - offset));
+    }
+    return data;
+}
+
+// Texto de muestra repetido hasta el tamanio pedido
+static std::vector<uint8_t> makeText(const std::vector<uint8_t>& text, size_t size) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; ++i) data[i] = text[i % text.size()];
+    return data;
+}
+
+// ---------------------------------------------------------------------------
+// Medicion
+
+struct Measure {
+    double seconds = 0;
+    double cyclesPerByte = -1;
+    size_t peakBytes = 0;
+};
+
+static uint64_t readCycles() {
+#ifdef HUFFMAN_BENCH_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Mejor tiempo de 'iterations' ejecuciones; el pico de memoria es el maximo
+template <typename F>
+static Measure measure(int iterations, size_t bytes, F&& run) {
+    Measure best;
+    best.seconds = 1e30;
+    for (int i = 0; i < iterations; ++i) {
+        size_t base = heapCurrent.load();
+        heapPeak.store(base);
+        auto start = std::chrono::steady_clock::now();
+        uint64_t cycles = readCycles();
+        run();
+        cycles = readCycles() - cycles;
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best.peakBytes = std::max(best.peakBytes, heapPeak.load() - base);
+        if (seconds < best.seconds) {
+            best.seconds = seconds;
+#ifdef HUFFMAN_BENCH_TSC
+            best.cyclesPerByte = static_cast<double>(cycles) / bytes;
+#endif
+        }
+    }
+    return best;
+}
+
+struct Row {
+    std::string corpus;
+    size_t size;
+    int streams;
+    unsigned threads;
+    size_t compressedSize;
+    Measure compress;
+    Measure decompress;
+};
+
+static std::vector<size_t> parseSizes(const std::string& list) {
+    std::vector<size_t> sizes;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) sizes.push_back(static_cast<size_t>(std::strtoull(item.c_str(), nullptr, 10)));
+    }
+    return sizes;
+}
+
+static void printCsv(const std::vector<Row>& rows) {
+    std::printf("corpus,size,streams,threads,compressed_size,ratio,compress_mbps,decompress_mbps,"
+                "compress_cycles_per_byte,decompress_cycles_per_byte,compress_peak_bytes,decompress_peak_bytes\n");
+    for (const Row& row : rows) {
+        std::printf("%s,%zu,%d,%u,%zu,%.4f,%.1f,%.1f,%.2f,%.2f,%zu,%zu\n", row.corpus.c_str(), row.size,
+                    row.streams, row.threads, row.compressedSize,
+                    static_cast<double>(row.compressedSize) / row.size,
+                    row.size / row.compress.seconds / 1e6, row.size / row.decompress.seconds / 1e6,
+                    row.compress.cyclesPerByte, row.decompress.cyclesPerByte,
+                    row.compress.peakBytes, row.decompress.peakBytes);
+    }
+}
+
+static void printJson(const std::vector<Row>& rows) {
+    std::printf("[\n");
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const Row& row = rows[i];
+        std::printf("  {\"corpus\": \"%s\", \"size\": %zu, \"streams\": %d, \"threads\": %u, "
+                    "\"compressed_size\": %zu, \"ratio\": %.4f, \"compress_mbps\": %.1f, \"decompress_mbps\": %.1f, "
+                    "\"compress_cycles_per_byte\": %.2f, \"decompress_cycles_per_byte\": %.2f, "
+                    "\"compress_peak_bytes\": %zu, \"decompress_peak_bytes\": %zu}%s\n",
+                    row.corpus.c_str(), row.size, row.streams, row.threads, row.compressedSize,
+                    static_cast<double>(row.compressedSize) / row.size,
+                    row.size / row.compress.seconds / 1e6, row.size / row.decompress.seconds / 1e6,
+                    row.compress.cyclesPerByte, row.decompress.cyclesPerByte,
+                    row.compress.peakBytes, row.decompress.peakBytes, i + 1 < rows.size() ? "," : "");
+    }
+    std::printf("]\n");
+}
+
+int main(int argc, char* argv[]) {
+    std::string format = "csv";
+    std::vector<size_t> sizes = {size_t(64) << 10, size_t(1) << 20, size_t(16) << 20};
+    int iterations = 5;
+    unsigned threads = 1;
+    std::string textPath = std::string(HUFFMAN_SOURCE_DIR) + "/lorenaipsum.txt";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--format" && i + 1 < argc) {
+            format = argv[++i];
+        } else if (arg == "--sizes" && i + 1 < argc) {
+            sizes = parseSizes(argv[++i]);
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (arg == "--text" && i + 1 < argc) {
+            textPath = argv[++i];
+        } else {
+            std::cerr << "Uso: huffman_bench [--format csv|json] [--sizes N,N,...] [--iterations N]"
+                         " [--threads N] [--text ruta]\n";
+            return 2;
+        }
+    }
+
+    std::ifstream textFile(textPath, std::ios::binary);
+    std::vector<uint8_t> text((std::istreambuf_iterator<char>(textFile)), std::istreambuf_iterator<char>());
+    if (text.empty()) std::cerr << "Aviso: no se pudo leer " << textPath << "; se omite el corpus de texto\n";
+
+    std::vector<Row> rows;
+    for (size_t size : sizes) {
+        if (size == 0) continue;
+        std::vector<std::pair<std::string, std::vector<uint8_t>>> corpus;
+        if (!text.empty()) corpus.emplace_back("lorenaipsum", makeText(text, size));
+        corpus.emplace_back("uniform", makeUniform(size));
+        corpus.emplace_back("zipf", makeZipf(size));
+        corpus.emplace_back("single", makeSingle(size));
+        corpus.emplace_back("binary", makeBinary(size));
+
+        for (const auto& [name, data] : corpus) {
+            for (int streams : {1, 4, 8}) {
+                CompressOptions options;
+                options.streams = streams;
+                options.threads = threads;
+                DecompressOptions decompressOptions;
+                decompressOptions.threads = threads;
+
+                std::vector<uint8_t> compressed;
+                std::vector<uint8_t> restored;
+                Row row{name, size, streams, threads, 0, {}, {}};
+                row.compress = measure(iterations, size, [&]() {
+                    std::vector<uint8_t>().swap(compressed);
+                    HuffmanCompressor::compress(data.data(), data.size(), compressed, options);
+                });
+                row.compressedSize = compressed.size();
+                row.decompress = measure(iterations, size, [&]() {
+                    std::vector<uint8_t>().swap(restored);
+                    HuffmanCompressor::decompress(compressed.data(), compressed.size(), restored, decompressOptions);
+                });
+
+                if (restored != data) {
+                    std::cerr << "Error: la descompresion no reproduce " << name << " (" << size << " bytes)\n";
+                    return 1;
+                }
+                rows.push_back(row);
+            }
+        }
+    }
+
+    if (format == "json") {
+        printJson(rows);
+    } else {
+        printCsv(rows);
+    }
+    return 0;
+}
@@ -0,0 +1,343 @@
+#include "huffman.hpp"
+#include "input_file.hpp"
+#include "pipeline.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Pie del archivo HUBA: posicion del directorio (8), cantidad (4) y "HDIR" (4)
+constexpr size_t ARCHIVE_TRAILER_SIZE = 16;
+
+// Cada miembro del directorio ocupa al menos su largo de ruta (2), tamanio,
+// fecha, posicion y tamanio comprimido (8 cada uno)
+constexpr size_t MIN_DIRECTORY_ENTRY = 34;
+
+// Nombre dentro del archivo: ruta relativa normalizada, con '/'. Si sale
+// del directorio actual ("..") se guarda solo el nombre del archivo.
+std::string memberName(const fs::path& path) {
+    fs::path name = path.lexically_normal().relative_path();
+    for (const fs::path& part : name) {
+        if (part == "..") return path.filename().generic_string();
+    }
+    return name.generic_string();
+}
+
+// Dos rutas nombran el mismo archivo si coinciden ya normalizadas
+bool sameSource(const std::string& a, const std::string& b) {
+    std::error_code error;
+    fs::path first = fs::absolute(a, error).lexically_normal();
+    fs::path second = fs::absolute(b, error).lexically_normal();
+    return first == second;
+}
+
+// Ruta de un miembro que no puede escribir fuera del directorio de destino
+bool safeMemberPath(const std::string& path) {
+    if (path.empty() || path.front() == '/' || path.find('\\') != std::string::npos) return false;
+    fs::path native(path);
+    if (native.is_absolute() || native.has_root_name()) return false;
+    size_t start = 0;
+    while (true) {
+        size_t slash = path.find('/', start);
+        std::string part = path.substr(start, slash == std::string::npos ? std::string::npos : slash - start);
+        if (part.empty() || part == "." || part == "..") return false;
+        if (slash == std::string::npos) return true;
+        start = slash + 1;
+    }
+}
+
+// Fechas en segundos desde 1970: el reloj de std::filesystem no tiene una
+// epoca fija en C++17, por lo que se convierte a traves de system_clock
+int64_t modificationTime(const std::string& path) {
+    std::error_code error;
+    fs::file_time_type time = fs::last_write_time(path, error);
+    if (error) return 0;
+    auto system = std::chrono::system_clock::now() +
+                  std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                      time - fs::file_time_type::clock::now());
+    return std::chrono::round<std::chrono::seconds>(system.time_since_epoch()).count();
+}
+
+void setModificationTime(const std::string& path, int64_t seconds) {
+    std::chrono::system_clock::time_point system{std::chrono::seconds(seconds)};
+    fs::file_time_type time = fs::file_time_type::clock::now() +
+                              std::chrono::duration_cast<fs::file_time_type::duration>(
+                                  system - std::chrono::system_clock::now());
+    std::error_code error;
+    fs::last_write_time(path, time, error);
+}
+
+} // namespace
+
+// Miembro en vuelo: el lector lo abre (mapeado), un hilo de trabajo lo
+// comprime en memoria y el escritor lo agrega al archivo en orden
+struct HuffmanCompressor::MemberJob {
+    std::string source;           // Ruta en el disco
+    ArchiveEntry entry;
+    InputFile input;
+    bool opened = false;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    std::vector<uint8_t> output;  // Flujo HUB3 del miembro (si es chico)
+    CompressReport report;
+    Status status = Status::Ok;
+    std::atomic<bool> ready{false};
+};
+
+Status HuffmanCompressor::createArchive(const std::vector<std::string>& inputPaths, const std::string& archivePath,
+                                        const CompressOptions& options, CompressReport* report,
+                                        std::pair<std::string, std::string>* duplicate) {
+    CompressReport local;
+    CompressReport& result = report ? *report : local;
+    result = CompressReport{};
+    result.stats.hardwareCounters = options.hardwareCounters;
+    Stats readStats;
+    readStats.hardwareCounters = options.hardwareCounters;
+
+    // Miembros (nombre, ruta en el disco) ordenados por nombre
+    std::vector<std::pair<std::string, std::string>> members;
+    {
+        PhaseTimer timer(readStats, readStats.read);
+        for (const std::string& path : inputPaths) {
+            std::error_code error;
+            if (!fs::is_directory(path, error)) {
+                members.emplace_back(memberName(path), path);
+                continue;
+            }
+            for (fs::recursive_directory_iterator it(path, error), end; !error && it != end; it.increment(error)) {
+                if (it->is_regular_file(error)) members.emplace_back(memberName(it->path()), it->path().string());
+            }
+            if (error) return Status::OpenFailed;
+        }
+    }
+    std::sort(members.begin(), members.end());
+
+    // Un nombre repetido solo se descarta si es el mismo archivo: dos
+    // archivos distintos con el mismo nombre perderian uno de los dos
+    for (size_t i = 1; i < members.size(); ) {
+        if (members[i].first != members[i - 1].first) {
+            ++i;
+        } else if (sameSource(members[i].second, members[i - 1].second)) {
+            members.erase(members.begin() + i);
+        } else {
+            if (duplicate) *duplicate = {members[i - 1].second, members[i].second};
+            return Status::DuplicateMember;
+        }
+    }
+
+    std::ofstream file;
+    std::ostream* output = openOutput(archivePath, file);
+    if (!output) return Status::CreateFailed;
+    uint64_t position = 0;
+    auto write = [&](const uint8_t* bytes, size_t count) {
+        output->write(reinterpret_cast<const char*>(bytes), count);
+        position += count;
+        return static_cast<bool>(*output);
+    };
+    const uint8_t magic[4] = {'H', 'U', 'B', 'A'};
+    write(magic, sizeof(magic));
+
+    // Los miembros de un bloque se comprimen en los hilos de trabajo, cada
+    // uno con un hilo y sin indice (no sirve con un bloque). Los mas grandes
+    // se comprimen en el escritor, directo al archivo y con todos los hilos.
+    size_t blockSize = std::clamp<size_t>(options.blockSize, MIN_BLOCK_SIZE, MAX_BLOCK_SIZE);
+    CompressOptions memberOptions = options;
+    memberOptions.threads = 1;
+    memberOptions.writeIndex = false;
+    unsigned threads = ThreadPool::resolve(options.threads);
+    std::vector<ArchiveEntry> entries;
+    entries.reserve(members.size());
+    Status failure = Status::Ok;
+
+    OrderedPipeline<MemberJob> jobs(threads, 2 * threads + 2, true,
+        [&](MemberJob& job, bool) {
+            job.output.clear();
+            job.status = !job.opened ? Status::OpenFailed : job.input.failed() ? Status::ReadFailed : Status::Ok;
+            if (job.status != Status::Ok || job.size == 0 || job.size > blockSize) return;
+            job.status = compress(job.data, job.size, job.output, memberOptions, &job.report);
+        },
+        [&](MemberJob& job) {
+            Status status = job.status;
+            job.entry.offset = position;
+            if (status == Status::Ok && job.size > blockSize) {
+                size_t consumed = 0;
+                status = compressStream([&job, &consumed](size_t maxBytes, std::vector<uint8_t>&, size_t& length) {
+                    length = std::min(maxBytes, job.size - consumed);
+                    consumed += length;
+                    return job.data + consumed - length;
+                }, write, options, job.report);
+            } else if (status == Status::Ok && job.size > 0) {
+                PhaseTimer timer(result.stats, result.stats.write);
+                if (!write(job.output.data(), job.output.size())) status = Status::WriteFailed;
+            }
+            job.input.close();
+            if (status != Status::Ok) {
+                failure = status;
+                return false;
+            }
+
+            job.entry.compressedSize = position - job.entry.offset;
+            entries.push_back(job.entry);
+            if (job.size > 0) {
+                result.originalSize += job.size;
+                result.optimalBits += job.report.optimalBits;
+                result.encodedBits += job.report.encodedBits;
+                result.longestCode = std::max(result.longestCode, job.report.longestCode);
+                result.limitedBlocks += job.report.limitedBlocks;
+                result.storedBlocks += job.report.storedBlocks;
+                result.stats.merge(job.report.stats);
+            }
+            return true;
+        });
+
+    // El lector abre cada miembro mientras los anteriores se comprimen
+    for (const auto& member : members) {
+        if (jobs.failed()) break;
+        MemberJob* job = jobs.acquire();
+        job->source = member.second;
+        job->entry = ArchiveEntry{};
+        job->entry.path = member.first;
+        job->report = CompressReport{};
+        job->data = nullptr;
+        job->size = 0;
+        {
+            PhaseTimer timer(readStats, readStats.read);
+            job->opened = job->input.open(job->source);
+            if (job->opened) job->data = job->input.contents(job->size);
+            job->entry.mtime = modificationTime(job->source);
+        }
+        job->entry.size = job->size;
+        jobs.submit(job);
+    }
+    if (!jobs.finish()) return failure;
+
+    // Directorio central, ordenado por ruta: ruta (largo de 2 bytes y
+    // bytes), tamanio, fecha, posicion y tamanio comprimido (8 bytes cada
+    // uno); luego la posicion del directorio, la cantidad y "HDIR"
+    std::vector<uint8_t> directory;
+    uint64_t directoryOffset = position;
+    for (const ArchiveEntry& entry : entries) {
+        if (entry.path.size() > 0xFFFF) return Status::CreateFailed;
+        putLE(directory, entry.path.size(), 2);
+        directory.insert(directory.end(), entry.path.begin(), entry.path.end());
+        putLE(directory, entry.size, 8);
+        putLE(directory, static_cast<uint64_t>(entry.mtime), 8);
+        putLE(directory, entry.offset, 8);
+        putLE(directory, entry.compressedSize, 8);
+    }
+    putLE(directory, directoryOffset, 8);
+    putLE(directory, entries.size(), 4);
+    directory.insert(directory.end(), {'H', 'D', 'I', 'R'});
+
+    PhaseTimer timer(result.stats, result.stats.write);
+    write(directory.data(), directory.size());
+    output->flush();
+    if (file.is_open()) file.close();
+    if (!*output) return Status::WriteFailed;
+
+    result.compressedSize = position;
+    result.stats.merge(readStats);
+    return Status::Ok;
+}
+
+HuffmanCompressor::ArchiveReader::ArchiveReader() = default;
+HuffmanCompressor::ArchiveReader::~ArchiveReader() = default;
+
+Status HuffmanCompressor::ArchiveReader::open(const std::string& path) {
+    entries_.clear();
+    file_ = std::make_unique<InputFile>();
+    // Los miembros se leen enteros pero en cualquier orden
+    if (!file_->open(path, InputFile::Access::Normal)) return Status::OpenFailed;
+    data_ = file_->contents(size_);
+    if (file_->failed()) return Status::ReadFailed;
+    if (size_ < 4 + ARCHIVE_TRAILER_SIZE || std::string(reinterpret_cast<const char*>(data_), 4) != "HUBA") {
+        return Status::InvalidFormat;
+    }
+
+    const uint8_t* trailer = data_ + size_ - ARCHIVE_TRAILER_SIZE;
+    uint64_t directoryOffset = readLE(trailer, 8);
+    uint64_t count = readLE(trailer, 4);
+    if (std::string(reinterpret_cast<const char*>(trailer), 4) != "HDIR") return Status::CorruptIndex;
+    if (directoryOffset < 4 || directoryOffset > size_ - ARCHIVE_TRAILER_SIZE) return Status::CorruptIndex;
+
+    // El limite evita reservar memoria por una cantidad corrupta
+    const uint8_t* ptr = data_ + directoryOffset;
+    const uint8_t* end = data_ + size_ - ARCHIVE_TRAILER_SIZE;
+    if (count > static_cast<uint64_t>(end - ptr) / MIN_DIRECTORY_ENTRY) return Status::CorruptIndex;
+    entries_.resize(static_cast<size_t>(count));
+
+    for (ArchiveEntry& entry : entries_) {
+        if (end - ptr < 2) return Status::CorruptIndex;
+        size_t length = static_cast<size_t>(readLE(ptr, 2));
+        if (static_cast<size_t>(end - ptr) < length + MIN_DIRECTORY_ENTRY - 2) return Status::CorruptIndex;
+        entry.path.assign(reinterpret_cast<const char*>(ptr), length);
+        ptr += length;
+        entry.size = readLE(ptr, 8);
+        entry.mtime = static_cast<int64_t>(readLE(ptr, 8));
+        entry.offset = readLE(ptr, 8);
+        entry.compressedSize = readLE(ptr, 8);
+
+        // Cada miembro dentro de la zona de datos, con una ruta segura y en
+        // orden estricto (find usa busqueda binaria)
+        if (entry.offset < 4 || entry.offset > directoryOffset ||
+            entry.compressedSize > directoryOffset - entry.offset ||
+            (entry.compressedSize == 0) != (entry.size == 0) || !safeMemberPath(entry.path) ||
+            (&entry != entries_.data() && !((&entry - 1)->path < entry.path))) {
+            entries_.clear();
+            return Status::CorruptIndex;
+        }
+    }
+    if (ptr != end) {
+        entries_.clear();
+        return Status::CorruptIndex;
+    }
+    return Status::Ok;
+}
+
+const ArchiveEntry* HuffmanCompressor::ArchiveReader::find(const std::string& path) const {
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), path,
+                               [](const ArchiveEntry& entry, const std::string& key) { return entry.path < key; });
+    return it != entries_.end() && it->path == path ? &*it : nullptr;
+}
+
+Status HuffmanCompressor::ArchiveReader::extract(const ArchiveEntry& entry, std::vector<uint8_t>& out,
+                                                 const DecompressOptions& options) const {
+    out.clear();
+    if (entry.compressedSize == 0) return Status::Ok;
+    Status status = decompress(data_ + entry.offset, static_cast<size_t>(entry.compressedSize), out, options);
+    if (status != Status::Ok) return status;
+    return out.size() == entry.size ? Status::Ok : Status::CorruptData;
+}
+
+Status HuffmanCompressor::ArchiveReader::extract(const ArchiveEntry& entry, const std::string& outputPath,
+                                                 const DecompressOptions& options, DecompressReport* report) const {
+    Stats stats;
+    stats.hardwareCounters = options.hardwareCounters;
+    fs::path target(outputPath);
+    if (target.has_parent_path()) {
+        std::error_code error;
+        fs::create_directories(target.parent_path(), error);
+    }
+
+    uint64_t bytesProduced = 0;
+    if (entry.compressedSize == 0) {
+        std::ofstream empty(outputPath, std::ios::binary);
+        if (!empty) return Status::CreateFailed;
+    } else {
+        Status status = decompressToFile(data_ + entry.offset, static_cast<size_t>(entry.compressedSize),
+                                         outputPath, options, bytesProduced, stats);
+        if (status != Status::Ok) return status;
+    }
+    if (bytesProduced != entry.size) return Status::CorruptData;
+    setModificationTime(outputPath, entry.mtime);
+
+    if (report) {
+        report->bytesProduced = bytesProduced;
+        report->stats = stats;
+    }
+    return Status::Ok;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Lector de bits MSB-first sobre un bloque contiguo de memoria.
+// Mantiene hasta 64 bits en un acumulador para poder mirar (peek)
+// varios bits a la vez; mas alla del final devuelve ceros.
+class BitReader {
+public:
+    BitReader() : start_(nullptr), ptr_(nullptr), end_(nullptr) {}
+    BitReader(const uint8_t* data, size_t size)
+        : start_(data), ptr_(data), end_(data + size) {}
+
+    // Garantiza al menos 56 bits en el acumulador
+    void refill() {
+        if (count_ > 56) return;
+        if (end_ - ptr_ >= 8) {
+            buffer_ |= loadBE64(ptr_) >> count_;
+            ptr_ += (63 - count_) >> 3;
+            count_ |= 56;
+            return;
+        }
+        while (count_ <= 56) {
+            uint64_t next = 0;
+            if (ptr_ < end_) {
+                next = *ptr_++;
+            } else {
+                padding_++;
+            }
+            buffer_ |= next << (56 - count_);
+            count_ += 8;
+        }
+    }
+
+    uint32_t peek(int bits) const {
+        return static_cast<uint32_t>(buffer_ >> (64 - bits));
+    }
+
+    void consume(int bits) {
+        buffer_ <<= bits;
+        count_ -= bits;
+    }
+
+    uint32_t read(int bits) {
+        uint32_t value = peek(bits);
+        consume(bits);
+        return value;
+    }
+
+    int available() const { return count_; }
+
+    // Bits consumidos desde el inicio (incluye el relleno de ceros)
+    uint64_t bitsConsumed() const {
+        return static_cast<uint64_t>(ptr_ - start_ + padding_) * 8 - count_;
+    }
+
+private:
+    static uint64_t loadBE64(const uint8_t* p) {
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) {
+            value = (value << 8) | p[i];
+        }
+        return value;
+    }
+
+    const uint8_t* start_;
+    const uint8_t* ptr_;
+    const uint8_t* end_;
+    uint64_t buffer_ = 0;
+    int count_ = 0;
+    size_t padding_ = 0;
+};
+
+// Escritor de bits MSB-first con acumulador de 64 bits.
+// Los codigos (hasta 32 bits) se agregan al acumulador y se vuelcan
+// en palabras de 32 bits al final del vector de salida.
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+    void write(uint32_t bits, int length) {
+        buffer_ = (buffer_ << length) | bits;
+        count_ += length;
+        total_ += length;
+        if (count_ >= 32) {
+            count_ -= 32;
+            uint32_t word = static_cast<uint32_t>(buffer_ >> count_);
+            uint8_t bytes[4] = {
+                static_cast<uint8_t>(word >> 24), static_cast<uint8_t>(word >> 16),
+                static_cast<uint8_t>(word >> 8), static_cast<uint8_t>(word)
+            };
+            out_.insert(out_.end(), bytes, bytes + 4);
+        }
+    }
+
+    // Vuelca los bits pendientes rellenando con ceros el ultimo byte
+    void flush() {
+        while (count_ >= 8) {
+            count_ -= 8;
+            out_.push_back(static_cast<uint8_t>(buffer_ >> count_));
+        }
+        if (count_ > 0) {
+            out_.push_back(static_cast<uint8_t>(buffer_ << (8 - count_)));
+            count_ = 0;
+        }
+    }
+
+    uint64_t bitsWritten() const { return total_; }
+
+private:
+    std::vector<uint8_t>& out_;
+    uint64_t buffer_ = 0;
+    int count_ = 0;
+    uint64_t total_ = 0;
+};
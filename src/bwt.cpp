@@ -0,0 +1,239 @@
+#include "bwt.hpp"
+#include <algorithm>
+#include <array>
+#include <numeric>
+
+template <typename Symbol>
+void Bwt::suffixArray(const Symbol* s, int n, int upper, int* sa) {
+    // SA-IS (Nong, Zhang y Chan) con un centinela virtual menor que todos
+    // los simbolos al final de s; los valores de s estan en 0..upper
+    if (n == 0) return;
+    if (n < 8) {
+        // Cadenas cortas: comparacion directa
+        std::iota(sa, sa + n, 0);
+        std::sort(sa, sa + n, [s, n](int a, int b) {
+            while (a < n && b < n && s[a] == s[b]) {
+                a++;
+                b++;
+            }
+            return b < n && (a == n || s[a] < s[b]);
+        });
+        return;
+    }
+
+    // Tipo de cada sufijo: S si es menor que el siguiente, L si no
+    std::vector<bool> isS(n);
+    for (int i = n - 2; i >= 0; --i) {
+        isS[i] = s[i] == s[i + 1] ? isS[i + 1] : s[i] < s[i + 1];
+    }
+
+    // Inicio de la zona L y de la zona S de cada simbolo en el arreglo
+    std::vector<int> startL(upper + 2, 0);
+    std::vector<int> startS(upper + 1, 0);
+    for (int i = 0; i < n; ++i) {
+        if (isS[i]) {
+            startL[s[i] + 1]++;
+        } else {
+            startS[s[i]]++;
+        }
+    }
+    for (int c = 0; c <= upper; ++c) {
+        startS[c] += startL[c];
+        startL[c + 1] += startS[c];
+    }
+
+    // Ordena todos los sufijos a partir del orden dado de los sufijos LMS
+    std::vector<int> bucket(upper + 2);
+    auto induce = [&](const std::vector<int>& lms) {
+        std::fill(sa, sa + n, -1);
+        std::copy(startS.begin(), startS.end(), bucket.begin());
+        for (int position : lms) {
+            sa[bucket[s[position]]++] = position;
+        }
+
+        std::copy(startL.begin(), startL.end() - 1, bucket.begin());
+        sa[bucket[s[n - 1]]++] = n - 1;
+        for (int i = 0; i < n; ++i) {
+            int v = sa[i];
+            if (v >= 1 && !isS[v - 1]) sa[bucket[s[v - 1]]++] = v - 1;
+        }
+
+        std::copy(startL.begin(), startL.end(), bucket.begin());
+        for (int i = n - 1; i >= 0; --i) {
+            int v = sa[i];
+            if (v >= 1 && isS[v - 1]) sa[--bucket[s[v - 1] + 1]] = v - 1;
+        }
+    };
+
+    // Sufijos LMS (S precedido por L) en orden de posicion
+    std::vector<int> lmsIndex(n + 1, -1);
+    std::vector<int> lms;
+    for (int i = 1; i < n; ++i) {
+        if (!isS[i - 1] && isS[i]) {
+            lmsIndex[i] = static_cast<int>(lms.size());
+            lms.push_back(i);
+        }
+    }
+    int m = static_cast<int>(lms.size());
+
+    induce(lms);
+    if (m == 0) return;
+
+    // Nombres de las subcadenas LMS ya ordenadas: iguales si coinciden
+    // simbolo a simbolo hasta la siguiente posicion LMS
+    std::vector<int> sortedLms;
+    sortedLms.reserve(m);
+    for (int i = 0; i < n; ++i) {
+        if (lmsIndex[sa[i]] != -1) sortedLms.push_back(sa[i]);
+    }
+    std::vector<int> reduced(m);
+    int names = 0;
+    reduced[lmsIndex[sortedLms[0]]] = 0;
+    for (int i = 1; i < m; ++i) {
+        int left = sortedLms[i - 1];
+        int right = sortedLms[i];
+        int endLeft = lmsIndex[left] + 1 < m ? lms[lmsIndex[left] + 1] : n;
+        int endRight = lmsIndex[right] + 1 < m ? lms[lmsIndex[right] + 1] : n;
+        bool same = endLeft - left == endRight - right;
+        if (same) {
+            while (left < endLeft && s[left] == s[right]) {
+                left++;
+                right++;
+            }
+            same = left != n && right != n && s[left] == s[right];
+        }
+        if (!same) names++;
+        reduced[lmsIndex[sortedLms[i]]] = names;
+    }
+
+    // Orden de los sufijos LMS por recursion sobre la cadena de nombres
+    std::vector<int> reducedSa(m);
+    suffixArray(reduced.data(), m, names, reducedSa.data());
+    for (int i = 0; i < m; ++i) {
+        sortedLms[i] = lms[reducedSa[i]];
+    }
+    induce(sortedLms);
+}
+
+uint32_t Bwt::forward(const uint8_t* data, size_t size, uint8_t* out) {
+    // Con el centinela al final, la fila 0 es el sufijo vacio (su ultima
+    // columna es el ultimo byte) y la fila i + 1 es el sufijo sa[i]. La fila
+    // del sufijo completo tendria el centinela y no se guarda.
+    int n = static_cast<int>(size);
+    std::vector<int> sa(size);
+    suffixArray(data, n, 255, sa.data());
+
+    uint32_t primary = 0;
+    size_t k = 0;
+    out[k++] = data[size - 1];
+    for (int i = 0; i < n; ++i) {
+        if (sa[i] == 0) {
+            primary = static_cast<uint32_t>(i + 1);
+        } else {
+            out[k++] = data[sa[i] - 1];
+        }
+    }
+    return primary;
+}
+
+bool Bwt::inverse(const uint8_t* data, size_t size, uint32_t primary, uint8_t* out) {
+    if (size == 0 || primary == 0 || primary > size) return false;
+
+    // Primera fila de cada byte en la primera columna (la fila 0 es el centinela)
+    std::array<uint32_t, 256> start{};
+    for (size_t i = 0; i < size; ++i) start[data[i]]++;
+    uint32_t sum = 1;
+    for (uint32_t& value : start) {
+        uint32_t count = value;
+        value = sum;
+        sum += count;
+    }
+
+    // next[j]: fila del sufijo que empieza un byte antes que el de la fila j
+    std::vector<uint32_t> next(size + 1);
+    for (size_t row = 0; row <= size; ++row) {
+        if (row == primary) continue;
+        uint8_t byte = data[row < primary ? row : row - 1];
+        next[row] = start[byte]++;
+    }
+
+    // Desde el final de la entrada hacia atras
+    uint32_t row = 0;
+    for (size_t i = size; i-- > 0;) {
+        if (row == primary) return false;
+        out[i] = data[row < primary ? row : row - 1];
+        row = next[row];
+    }
+    return row == primary;
+}
+
+void Bwt::encodeMtf(const uint8_t* data, size_t size, std::vector<uint16_t>& symbols) {
+    symbols.clear();
+    symbols.reserve(size / 2);
+    std::array<uint8_t, 256> order;
+    std::iota(order.begin(), order.end(), 0);
+
+    // Corrida de ceros de longitud run en base 2 biyectiva (digitos 1 y 2)
+    auto flushRun = [&symbols](size_t run) {
+        while (run > 0) {
+            run--;
+            symbols.push_back(static_cast<uint16_t>((run & 1) ? RUNB : RUNA));
+            run >>= 1;
+        }
+    };
+
+    size_t run = 0;
+    for (size_t i = 0; i < size; ++i) {
+        uint8_t byte = data[i];
+        if (order[0] == byte) {
+            run++;
+            continue;
+        }
+        flushRun(run);
+        run = 0;
+
+        // Mover el byte al frente corriendo los anteriores una posicion
+        int position = 1;
+        uint8_t previous = order[0];
+        order[0] = byte;
+        while (order[position] != byte) {
+            std::swap(previous, order[position]);
+            position++;
+        }
+        order[position] = previous;
+        symbols.push_back(static_cast<uint16_t>(position + 1));
+    }
+    flushRun(run);
+}
+
+bool Bwt::decodeMtf(const uint16_t* symbols, size_t count, uint8_t* out, size_t size) {
+    std::array<uint8_t, 256> order;
+    std::iota(order.begin(), order.end(), 0);
+
+    size_t produced = 0;
+    size_t i = 0;
+    while (i < count) {
+        if (symbols[i] <= RUNB) {
+            // Corrida de ceros: repetir el byte del frente
+            size_t run = 0;
+            size_t weight = 1;
+            while (i < count && symbols[i] <= RUNB) {
+                run += weight << symbols[i];
+                weight <<= 1;
+                if (run > size - produced) return false;
+                i++;
+            }
+            std::fill_n(out + produced, run, order[0]);
+            produced += run;
+            continue;
+        }
+
+        int position = symbols[i++] - 1;
+        if (position > 255 || produced == size) return false;
+        uint8_t byte = order[position];
+        std::copy_backward(order.begin(), order.begin() + position, order.begin() + position + 1);
+        order[0] = byte;
+        out[produced++] = byte;
+    }
+    return produced == size;
+}
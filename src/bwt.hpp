@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Transformacion previa al estilo bzip2: Burrows-Wheeler (arreglo de sufijos
+// en tiempo lineal con SA-IS), move-to-front y codificacion de las corridas
+// de ceros. El resultado son simbolos de un alfabeto de 257 que se codifican
+// con Huffman como cualquier otro bloque.
+class Bwt {
+public:
+    // Simbolos de la salida de encodeMtf: RUNA y RUNB escriben en base 2
+    // biyectiva la longitud de una corrida de ceros; la posicion p (1..255)
+    // de un byte en la lista MTF se escribe como p + 1
+    static constexpr int RUNA = 0;
+    static constexpr int RUNB = 1;
+    static constexpr int ALPHABET = 257;
+
+    // Transformada de data[0..size) en out (size bytes). Devuelve la fila
+    // que ocuparia el centinela (1..size), necesaria para invertirla
+    static uint32_t forward(const uint8_t* data, size_t size, uint8_t* out);
+
+    // Inversa de forward; false si primary no es valido
+    static bool inverse(const uint8_t* data, size_t size, uint32_t primary, uint8_t* out);
+
+    // Move-to-front y corridas de ceros (reemplaza symbols)
+    static void encodeMtf(const uint8_t* data, size_t size, std::vector<uint16_t>& symbols);
+
+    // Inversa de encodeMtf; false si los simbolos no producen exactamente size bytes
+    static bool decodeMtf(const uint16_t* symbols, size_t count, uint8_t* out, size_t size);
+
+private:
+    template <typename Symbol>
+    static void suffixArray(const Symbol* s, int n, int upper, int* sa);
+};
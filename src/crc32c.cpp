@@ -0,0 +1,186 @@
+#include "crc32c.hpp"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CRC32C_X86 1
+#include <nmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define CRC32C_TARGET
+#else
+#define CRC32C_TARGET __attribute__((target("sse4.2")))
+#endif
+#endif
+
+struct Crc32c::Tables {
+    uint32_t slice[8][256];
+    uint32_t powers[32];        // x^(2^k) modulo el polinomio
+    uint32_t longShift[4][256]; // Agregar LONG_BLOCK bytes en cero, por byte del CRC
+    uint32_t shortShift[4][256];
+    bool hardware;
+};
+
+// Producto de polinomios modulo POLY (bits reflejados: el bit 31 es x^0)
+static uint32_t multiply(uint32_t a, uint32_t b, uint32_t poly) {
+    uint32_t mask = 1u << 31;
+    uint32_t product = 0;
+    for (;;) {
+        if (a & mask) {
+            product ^= b;
+            if ((a & (mask - 1)) == 0) break;
+        }
+        mask >>= 1;
+        b = b & 1 ? (b >> 1) ^ poly : b >> 1;
+    }
+    return product;
+}
+
+// x^(n * 2^k) modulo el polinomio
+static uint32_t powerOfX(const uint32_t* powers, uint64_t n, int k, uint32_t poly) {
+    uint32_t power = 1u << 31;
+    while (n) {
+        if (n & 1) power = multiply(powers[k & 31], power, poly);
+        n >>= 1;
+        k++;
+    }
+    return power;
+}
+
+static bool detectHardware() {
+#if defined(CRC32C_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#elif defined(CRC32C_X86)
+    return __builtin_cpu_supports("sse4.2");
+#else
+    return false;
+#endif
+}
+
+const Crc32c::Tables& Crc32c::tables() {
+    static const Tables instance = [] {
+        Tables t;
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) crc = crc & 1 ? (crc >> 1) ^ POLY : crc >> 1;
+            t.slice[0][i] = crc;
+        }
+        for (int k = 1; k < 8; ++k) {
+            for (int i = 0; i < 256; ++i) {
+                uint32_t previous = t.slice[k - 1][i];
+                t.slice[k][i] = (previous >> 8) ^ t.slice[0][previous & 0xFF];
+            }
+        }
+
+        uint32_t power = 1u << 30;
+        for (uint32_t& value : t.powers) {
+            value = power;
+            power = multiply(power, power, POLY);
+        }
+
+        // Desplazar un CRC n bytes es multiplicarlo por x^(8n): lineal en
+        // cada byte del CRC
+        uint32_t longPower = powerOfX(t.powers, LONG_BLOCK, 3, POLY);
+        uint32_t shortPower = powerOfX(t.powers, SHORT_BLOCK, 3, POLY);
+        for (int k = 0; k < 4; ++k) {
+            for (uint32_t i = 0; i < 256; ++i) {
+                t.longShift[k][i] = multiply(longPower, i << (8 * k), POLY);
+                t.shortShift[k][i] = multiply(shortPower, i << (8 * k), POLY);
+            }
+        }
+
+        t.hardware = detectHardware();
+        return t;
+    }();
+    return instance;
+}
+
+static uint32_t shift(const uint32_t (&table)[4][256], uint32_t crc) {
+    return table[0][crc & 0xFF] ^ table[1][(crc >> 8) & 0xFF] ^ table[2][(crc >> 16) & 0xFF] ^
+           table[3][crc >> 24];
+}
+
+uint32_t Crc32c::sliceBy8(const Tables& t, uint32_t crc, const uint8_t* data, size_t size) {
+    // Ocho bytes por vuelta con una tabla por posicion
+    while (size >= 8) {
+        uint32_t low = crc ^ (uint32_t(data[0]) | uint32_t(data[1]) << 8 | uint32_t(data[2]) << 16 |
+                              uint32_t(data[3]) << 24);
+        uint32_t high = uint32_t(data[4]) | uint32_t(data[5]) << 8 | uint32_t(data[6]) << 16 |
+                        uint32_t(data[7]) << 24;
+        crc = t.slice[7][low & 0xFF] ^ t.slice[6][(low >> 8) & 0xFF] ^ t.slice[5][(low >> 16) & 0xFF] ^
+              t.slice[4][low >> 24] ^ t.slice[3][high & 0xFF] ^ t.slice[2][(high >> 8) & 0xFF] ^
+              t.slice[1][(high >> 16) & 0xFF] ^ t.slice[0][high >> 24];
+        data += 8;
+        size -= 8;
+    }
+    while (size-- > 0) {
+        crc = t.slice[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#ifdef CRC32C_X86
+CRC32C_TARGET uint32_t Crc32c::updateHardware(const Tables& t, uint32_t crc, const uint8_t* data, size_t size) {
+    // La instruccion tiene latencia 3 y rendimiento 1: tres tramos
+    // independientes la mantienen ocupada. El CRC de A seguido de B es el de
+    // A desplazado |B| bytes mas el de B empezando desde 0.
+    auto load = [](const uint8_t* p) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        return word;
+    };
+    uint64_t c0 = crc;
+    const size_t blocks[2] = {LONG_BLOCK, SHORT_BLOCK};
+    const uint32_t (*shifts[2])[4][256] = {&t.longShift, &t.shortShift};
+    for (int pass = 0; pass < 2; ++pass) {
+        size_t block = blocks[pass];
+        while (size >= 3 * block) {
+            uint64_t c1 = 0;
+            uint64_t c2 = 0;
+            for (const uint8_t* end = data + block; data < end; data += 8) {
+                c0 = _mm_crc32_u64(c0, load(data));
+                c1 = _mm_crc32_u64(c1, load(data + block));
+                c2 = _mm_crc32_u64(c2, load(data + 2 * block));
+            }
+            c0 = shift(*shifts[pass], static_cast<uint32_t>(c0)) ^ c1;
+            c0 = shift(*shifts[pass], static_cast<uint32_t>(c0)) ^ c2;
+            data += 2 * block;
+            size -= 3 * block;
+        }
+    }
+
+    for (; size >= 8; size -= 8, data += 8) {
+        c0 = _mm_crc32_u64(c0, load(data));
+    }
+    uint32_t result = static_cast<uint32_t>(c0);
+    while (size-- > 0) {
+        result = _mm_crc32_u8(result, *data++);
+    }
+    return result;
+}
+#else
+uint32_t Crc32c::updateHardware(const Tables& t, uint32_t crc, const uint8_t* data, size_t size) {
+    return sliceBy8(t, crc, data, size);
+}
+#endif
+
+uint32_t Crc32c::update(uint32_t crc, const uint8_t* data, size_t size) {
+    const Tables& t = tables();
+    crc = ~crc;
+    crc = t.hardware ? updateHardware(t, crc, data, size) : sliceBy8(t, crc, data, size);
+    return ~crc;
+}
+
+uint32_t Crc32c::updateSoftware(uint32_t crc, const uint8_t* data, size_t size) {
+    return ~sliceBy8(tables(), ~crc, data, size);
+}
+
+uint32_t Crc32c::combine(uint32_t crcA, uint32_t crcB, uint64_t sizeB) {
+    const Tables& t = tables();
+    return multiply(powerOfX(t.powers, sizeB, 3, POLY), crcA, POLY) ^ crcB;
+}
+
+bool Crc32c::hardware() {
+    return tables().hardware;
+}
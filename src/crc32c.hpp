@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC32C (polinomio de Castagnoli, el de iSCSI y ext4). En x86-64 con
+// SSE4.2 usa la instruccion crc32 sobre tres tramos intercalados, que se
+// unen con tablas de desplazamiento; si no, slice-by-8 por software.
+class Crc32c {
+public:
+    // CRC de data[0..size) continuando el de los datos anteriores (0 al empezar)
+    static uint32_t update(uint32_t crc, const uint8_t* data, size_t size);
+
+    static uint32_t compute(const uint8_t* data, size_t size) { return update(0, data, size); }
+
+    // CRC de A seguido de B a partir del de cada uno y el tamanio de B
+    static uint32_t combine(uint32_t crcA, uint32_t crcB, uint64_t sizeB);
+
+    // true si el procesador tiene la instruccion crc32 (SSE4.2)
+    static bool hardware();
+
+    // Solo por software, para comparar con la version por hardware
+    static uint32_t updateSoftware(uint32_t crc, const uint8_t* data, size_t size);
+
+private:
+    static constexpr uint32_t POLY = 0x82F63B78; // Reflejado
+
+    // Tramos de la version por hardware: se procesan de a tres en paralelo
+    static constexpr size_t LONG_BLOCK = 8192;
+    static constexpr size_t SHORT_BLOCK = 256;
+
+    struct Tables;
+    static const Tables& tables();
+
+    // Sin el complemento inicial y final
+    static uint32_t sliceBy8(const Tables& t, uint32_t crc, const uint8_t* data, size_t size);
+    static uint32_t updateHardware(const Tables& t, uint32_t crc, const uint8_t* data, size_t size);
+};
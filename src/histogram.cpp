@@ -0,0 +1,112 @@
+#include "histogram.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+void Histogram::count(const uint8_t* data, size_t size, std::array<uint64_t, 256>& freq, unsigned threads) {
+    freq.fill(0);
+
+    size_t parts = std::min<size_t>(std::max(threads, 1u), size / MIN_PARALLEL_CHUNK);
+    if (parts <= 1) {
+        countSerial(data, size, freq);
+        return;
+    }
+
+    // Un tramo por hilo; el hilo actual procesa el primero
+    std::vector<std::array<uint64_t, 256>> partial(parts);
+    std::vector<std::thread> workers;
+    size_t chunk = (size + parts - 1) / parts;
+    for (size_t t = 1; t < parts; ++t) {
+        size_t begin = t * chunk;
+        size_t length = std::min(chunk, size - begin);
+        workers.emplace_back([&partial, data, begin, length, t]() {
+            partial[t].fill(0);
+            countSerial(data + begin, length, partial[t]);
+        });
+    }
+    countSerial(data, chunk, freq);
+
+    for (size_t t = 1; t < parts; ++t) {
+        workers[t - 1].join();
+        for (int i = 0; i < 256; ++i) freq[i] += partial[t][i];
+    }
+}
+
+void Histogram::countSerial(const uint8_t* data, size_t size, std::array<uint64_t, 256>& freq) {
+    // Contadores de 32 bits: se procesa por tramos que no los desbordan
+    constexpr size_t MAX_CHUNK = size_t(1) << 30;
+
+    while (size > 0) {
+        size_t length = std::min(size, MAX_CHUNK);
+        uint32_t tables[4][256] = {};
+        const uint8_t* ptr = data;
+        const uint8_t* end = data + length;
+
+        // Una palabra de 4 bytes por iteracion, cargando la siguiente por
+        // adelantado; cada byte de la palabra va a una subtabla distinta
+        if (end - ptr >= 8) {
+            uint32_t word;
+            std::memcpy(&word, ptr, 4);
+            while (end - ptr >= 8) {
+                uint32_t next;
+                std::memcpy(&next, ptr + 4, 4);
+                tables[0][word & 0xFF]++;
+                tables[1][(word >> 8) & 0xFF]++;
+                tables[2][(word >> 16) & 0xFF]++;
+                tables[3][word >> 24]++;
+                word = next;
+                ptr += 4;
+            }
+        }
+        while (ptr < end) {
+            tables[0][*ptr++]++;
+        }
+
+        for (int i = 0; i < 256; ++i) {
+            freq[i] += uint64_t(tables[0][i]) + tables[1][i] + tables[2][i] + tables[3][i];
+        }
+
+        data += length;
+        size -= length;
+    }
+}
+
+void Histogram::countContexts(const uint8_t* data, size_t size, std::array<uint32_t, 256>* counts) {
+    for (int i = 0; i < 256; ++i) counts[i].fill(0);
+
+    uint8_t previous = 0;
+    for (size_t i = 0; i < size; ++i) {
+        counts[previous][data[i]]++;
+        previous = data[i];
+    }
+}
+
+void Histogram::countSample(const uint8_t* data, size_t size, std::array<uint64_t, 256>& freq) {
+    if (size <= SAMPLE_CHUNK * SAMPLE_CHUNKS) {
+        count(data, size, freq);
+        return;
+    }
+
+    // Tramos equiespaciados: el primero al principio y el ultimo al final
+    freq.fill(0);
+    size_t stride = (size - SAMPLE_CHUNK) / (SAMPLE_CHUNKS - 1);
+    for (size_t k = 0; k < SAMPLE_CHUNKS; ++k) {
+        countSerial(data + k * stride, SAMPLE_CHUNK, freq);
+    }
+}
+
+double Histogram::entropy(const std::array<uint64_t, 256>& freq) {
+    uint64_t total = 0;
+    for (uint64_t value : freq) total += value;
+    if (total == 0) return 0.0;
+
+    double bits = 0.0;
+    for (uint64_t value : freq) {
+        if (value == 0) continue;
+        double p = static_cast<double>(value) / static_cast<double>(total);
+        bits -= p * std::log2(p);
+    }
+    return bits;
+}
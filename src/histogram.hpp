@@ -0,0 +1,38 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Conteo de frecuencias de bytes.
+// Cuenta en varias subtablas intercaladas para que las corridas del mismo
+// byte no encadenen incrementos sobre el mismo contador, y en buffers
+// grandes reparte el trabajo entre varios hilos.
+class Histogram {
+public:
+    // Reemplaza freq con las frecuencias de data[0..size)
+    static void count(const uint8_t* data, size_t size, std::array<uint64_t, 256>& freq,
+                      unsigned threads = 1);
+
+    // Frecuencias de orden 1: counts[a][b] es la cantidad de veces que el
+    // byte b sigue al byte a en data[0..size). El primer byte cuenta con el
+    // contexto 0. size debe caber en 32 bits.
+    static void countContexts(const uint8_t* data, size_t size, std::array<uint32_t, 256>* counts);
+
+    // Frecuencias de SAMPLE_CHUNKS tramos de SAMPLE_CHUNK bytes repartidos a
+    // lo largo de data[0..size) (todo data si es mas chico que la muestra)
+    static void countSample(const uint8_t* data, size_t size, std::array<uint64_t, 256>& freq);
+
+    // Entropia de Shannon en bits por byte: cota inferior del codigo de
+    // orden 0 para esas frecuencias
+    static double entropy(const std::array<uint64_t, 256>& freq);
+
+    static constexpr size_t SAMPLE_CHUNK = size_t(4) << 10;
+    static constexpr size_t SAMPLE_CHUNKS = 16;
+
+    // Tamanio minimo de cada tramo para que valga la pena un hilo extra
+    static constexpr size_t MIN_PARALLEL_CHUNK = size_t(256) << 10;
+
+private:
+    static void countSerial(const uint8_t* data, size_t size, std::array<uint64_t, 256>& freq);
+};
@@ -1,287 +1,2717 @@
 #include "huffman.hpp"
+#include "bitstream.hpp"
+#include "bwt.hpp"
+#include "crc32c.hpp"
+#include "histogram.hpp"
+#include "lz77.hpp"
+#include "input_file.hpp"
+#include "pipeline.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <filesystem>
-#include <iomanip>
 
-void HuffmanCompressor::buildCodes(const Node* node, const std::string& code, std::vector<std::string>& codes) {
-    if (!node) return;
-    
-    if (node->byte >= 0) {
-        codes[static_cast<uint8_t>(node->byte)] = code.empty() ? "0" : code;
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+bool HuffmanCompressor::buildTree(const std::array<uint64_t, 256>& freq, Tree& tree) {
+    // Misma secuencia de push_heap/pop_heap que la cola de prioridad original
+    // (min-heap por frecuencia), para que los empates se resuelvan igual
+    std::array<uint64_t, TREE_NODES> weight;
+    std::array<int16_t, 256> heap;
+    size_t heapSize = 0;
+    auto greater = [&weight](int16_t a, int16_t b) { return weight[a] > weight[b]; };
+
+    for (int i = 0; i < 256; ++i) {
+        if (freq[i] > 0) {
+            weight[i] = freq[i];
+            heap[heapSize++] = static_cast<int16_t>(i);
+            std::push_heap(heap.begin(), heap.begin() + heapSize, greater);
+        }
+    }
+
+    if (heapSize == 0) return false;
+
+    int next = 256;
+    if (heapSize == 1) {
+        // Caso especial: solo un simbolo unico
+        weight[next] = weight[heap[0]];
+        tree.child[next] = {heap[0], -1};
+        heap[0] = static_cast<int16_t>(next++);
+    }
+
+    while (heapSize > 1) {
+        std::pop_heap(heap.begin(), heap.begin() + heapSize--, greater);
+        int16_t a = heap[heapSize];
+        std::pop_heap(heap.begin(), heap.begin() + heapSize--, greater);
+        int16_t b = heap[heapSize];
+
+        weight[next] = weight[a] + weight[b];
+        tree.child[next] = {a, b};
+        heap[heapSize++] = static_cast<int16_t>(next++);
+        std::push_heap(heap.begin(), heap.begin() + heapSize, greater);
+    }
+
+    tree.root = heap[0];
+    return true;
+}
+
+void HuffmanCompressor::buildDecodeTable(const Tree& tree, int node, uint32_t code, int length,
+                                         std::vector<DecodeEntry>& table) {
+    if (node < 0) return;
+
+    if (node < 256) {
+        // Todas las entradas que empiezan con este codigo resuelven el simbolo
+        int fill = DECODE_TABLE_BITS - length;
+        uint32_t first = code << fill;
+        for (uint32_t i = 0; i < (1u << fill); ++i) {
+            table[first + i] = {static_cast<uint16_t>(node), static_cast<uint8_t>(length)};
+        }
         return;
     }
-    
-    buildCodes(node->left.get(), code + '0', codes);
-    buildCodes(node->right.get(), code + '1', codes);
+
+    // Los nodos internos a la profundidad maxima quedan para el camino lento
+    if (length == DECODE_TABLE_BITS) return;
+
+    buildDecodeTable(tree, tree.child[node][0], code << 1, length + 1, table);
+    buildDecodeTable(tree, tree.child[node][1], (code << 1) | 1, length + 1, table);
+}
+
+void HuffmanCompressor::huffmanCodeLengths(const uint64_t* freq, int count, uint8_t* lengths) {
+    // Simbolos presentes ordenados por frecuencia creciente
+    std::array<uint64_t, MAX_ALPHABET> sorted;
+    std::array<uint16_t, MAX_ALPHABET> symbols;
+    int n = 0;
+    for (int i = 0; i < count; ++i) {
+        lengths[i] = 0;
+        if (freq[i] > 0) symbols[n++] = static_cast<uint16_t>(i);
+    }
+    if (n == 0) return;
+    if (n == 1) {
+        lengths[symbols[0]] = 1;
+        return;
+    }
+    std::sort(symbols.begin(), symbols.begin() + n, [freq](uint16_t a, uint16_t b) {
+        return freq[a] < freq[b] || (freq[a] == freq[b] && a < b);
+    });
+    for (int i = 0; i < n; ++i) sorted[i] = freq[symbols[i]];
+
+    // Moffat-Katajainen en el mismo arreglo. Primera pasada: los nodos
+    // internos se forman en orden (dos colas: hojas y nodos ya formados) y
+    // cada uno guarda el indice de su padre en lugar del peso
+    uint64_t* a = sorted.data();
+    a[0] += a[1];
+    int root = 0;
+    int leaf = 2;
+    for (int next = 1; next < n - 1; ++next) {
+        if (leaf >= n || a[root] < a[leaf]) {
+            a[next] = a[root];
+            a[root++] = next;
+        } else {
+            a[next] = a[leaf++];
+        }
+        if (leaf >= n || (root < next && a[root] < a[leaf])) {
+            a[next] += a[root];
+            a[root++] = next;
+        } else {
+            a[next] += a[leaf++];
+        }
+    }
+
+    // Segunda pasada: profundidad de cada nodo interno (la raiz es n-2)
+    a[n - 2] = 0;
+    for (int next = n - 3; next >= 0; --next) {
+        a[next] = a[a[next]] + 1;
+    }
+
+    // Tercera pasada: las hojas ocupan los lugares libres de cada nivel, las
+    // de menor frecuencia en los niveles mas profundos
+    int available = 1;
+    int used = 0;
+    uint64_t depth = 0;
+    int next = n - 1;
+    root = n - 2;
+    while (available > 0) {
+        while (root >= 0 && a[root] == depth) {
+            used++;
+            root--;
+        }
+        while (available > used) {
+            a[next--] = depth;
+            available--;
+        }
+        available = 2 * used;
+        depth++;
+        used = 0;
+    }
+
+    for (int i = 0; i < n; ++i) {
+        lengths[symbols[i]] = static_cast<uint8_t>(a[i]);
+    }
+}
+
+void HuffmanCompressor::limitCodeLengths(const uint64_t* freq, int count, int maxLength, uint8_t* lengths) {
+    // Package-merge: longitudes optimas sujetas a longitud <= maxLength.
+    // Cada nivel tiene a lo sumo 2n-1 elementos, por lo que todo cabe en
+    // arreglos fijos
+    constexpr int MAX_ITEMS = 2 * MAX_ALPHABET;
+    std::array<uint64_t, MAX_ALPHABET> leafWeight;
+    std::array<int16_t, MAX_ALPHABET> leafSymbol;
+    int n = 0;
+    for (int i = 0; i < count; ++i) {
+        lengths[i] = 0;
+        if (freq[i] > 0) leafSymbol[n++] = static_cast<int16_t>(i);
+    }
+
+    if (n == 0) return;
+    if (n == 1) {
+        lengths[leafSymbol[0]] = 1;
+        return;
+    }
+
+    std::stable_sort(leafSymbol.begin(), leafSymbol.begin() + n, [freq](int16_t a, int16_t b) {
+        return freq[a] < freq[b];
+    });
+    for (int i = 0; i < n; ++i) leafWeight[i] = freq[leafSymbol[i]];
+
+    // El nivel 0 son las hojas; cada nivel mezcla las hojas con los paquetes
+    // formados por pares consecutivos del nivel anterior. De cada nivel se
+    // guarda el simbolo de cada elemento (-1 para paquetes); los pesos solo
+    // hacen falta del nivel anterior
+    std::array<std::array<int16_t, MAX_ITEMS>, MAX_CODE_LENGTH> levelSymbol;
+    std::array<int, MAX_CODE_LENGTH> levelSize;
+    std::array<uint64_t, MAX_ITEMS> previousWeight;
+    std::array<uint64_t, MAX_ITEMS> currentWeight;
+
+    std::copy(leafSymbol.begin(), leafSymbol.begin() + n, levelSymbol[0].begin());
+    std::copy(leafWeight.begin(), leafWeight.begin() + n, previousWeight.begin());
+    levelSize[0] = n;
+    for (int level = 1; level < maxLength; ++level) {
+        int previousSize = levelSize[level - 1];
+        int size = 0;
+        int leaf = 0;
+        int pair = 0;
+        while (leaf < n || pair + 1 < previousSize) {
+            bool takePackage = pair + 1 < previousSize &&
+                (leaf == n || previousWeight[pair] + previousWeight[pair + 1] < leafWeight[leaf]);
+            if (takePackage) {
+                currentWeight[size] = previousWeight[pair] + previousWeight[pair + 1];
+                levelSymbol[level][size++] = -1;
+                pair += 2;
+            } else {
+                currentWeight[size] = leafWeight[leaf];
+                levelSymbol[level][size++] = leafSymbol[leaf++];
+            }
+        }
+        levelSize[level] = size;
+        std::swap(previousWeight, currentWeight);
+    }
+
+    // Se eligen los primeros 2n-2 elementos del ultimo nivel; cada hoja
+    // seleccionada en un nivel suma un bit a su longitud y cada paquete
+    // selecciona dos elementos del nivel inferior
+    int selected = 2 * n - 2;
+    for (int level = maxLength - 1; level >= 0 && selected > 0; --level) {
+        int packages = 0;
+        for (int i = 0; i < selected; ++i) {
+            int symbol = levelSymbol[level][i];
+            if (symbol >= 0) {
+                lengths[symbol]++;
+            } else {
+                packages++;
+            }
+        }
+        selected = 2 * packages;
+    }
+}
+
+void HuffmanCompressor::assignCanonicalCodes(const uint8_t* lengths, int count, Code* codes) {
+    // Codigos canonicos: mas cortos primero y, dentro de cada longitud,
+    // en orden creciente de simbolo
+    std::array<uint32_t, MAX_CODE_LENGTH + 2> lengthCount{};
+    for (int i = 0; i < count; ++i) {
+        lengthCount[lengths[i]]++;
+    }
+    lengthCount[0] = 0;
+
+    std::array<uint32_t, MAX_CODE_LENGTH + 2> nextCode{};
+    uint32_t code = 0;
+    for (int len = 1; len <= MAX_CODE_LENGTH; ++len) {
+        code = (code + lengthCount[len - 1]) << 1;
+        nextCode[len] = code;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        codes[i] = {lengths[i] ? nextCode[lengths[i]]++ : 0, lengths[i]};
+    }
+}
+
+bool HuffmanCompressor::buildCanonicalDecodeTable(const uint8_t* lengths, int count, DecodeTable& table) {
+    table.count.fill(0);
+    table.maxLength = 0;
+    for (int i = 0; i < count; ++i) {
+        if (lengths[i] > MAX_CODE_LENGTH) return false;
+        table.count[lengths[i]]++;
+        table.maxLength = std::max<int>(table.maxLength, lengths[i]);
+    }
+    table.count[0] = 0;
+    if (table.maxLength == 0) return false;
+
+    // Verificar que el codigo no este sobresuscrito (desigualdad de Kraft)
+    uint64_t kraft = 0;
+    for (int len = 1; len <= table.maxLength; ++len) {
+        kraft += static_cast<uint64_t>(table.count[len]) << (MAX_CODE_LENGTH - len);
+    }
+    if (kraft > (uint64_t(1) << MAX_CODE_LENGTH)) return false;
+
+    // Primer codigo y desplazamiento en sortedSymbols por longitud
+    uint32_t code = 0;
+    uint32_t offset = 0;
+    for (int len = 1; len <= MAX_CODE_LENGTH; ++len) {
+        code = (code + table.count[len - 1]) << 1;
+        table.firstCode[len] = code;
+        table.offset[len] = offset;
+        offset += table.count[len];
+    }
+
+    table.sortedSymbols.assign(offset, 0);
+    std::array<uint32_t, MAX_CODE_LENGTH + 1> position = table.offset;
+    for (int i = 0; i < count; ++i) {
+        if (lengths[i]) table.sortedSymbols[position[lengths[i]]++] = static_cast<uint16_t>(i);
+    }
+
+    // Tabla rapida: cada codigo corto ocupa 2^(DECODE_TABLE_BITS - len) entradas
+    table.fast.assign(size_t(1) << DECODE_TABLE_BITS, DecodeEntry{0, 0});
+    std::vector<Code> codes(count);
+    assignCanonicalCodes(lengths, count, codes.data());
+    for (int i = 0; i < count; ++i) {
+        int len = codes[i].length;
+        if (len == 0 || len > DECODE_TABLE_BITS) continue;
+        int fill = DECODE_TABLE_BITS - len;
+        uint32_t first = codes[i].bits << fill;
+        for (uint32_t j = 0; j < (1u << fill); ++j) {
+            table.fast[first + j] = {static_cast<uint16_t>(i), static_cast<uint8_t>(len)};
+        }
+    }
+
+    return true;
+}
+
+inline int HuffmanCompressor::decodeSymbol(BitReader& reader, const DecodeEntry* fast, const DecodeTable& table) {
+    // Requiere al menos maxLength bits en el acumulador
+    DecodeEntry entry = fast[reader.peek(DECODE_TABLE_BITS)];
+    if (entry.length > 0) {
+        reader.consume(entry.length);
+        return entry.symbol;
+    }
+    return decodeSlow(reader, table);
+}
+
+int HuffmanCompressor::decodeSlow(BitReader& reader, const DecodeTable& table, int tableBits) {
+    // Camino lento: buscar la longitud cuyo rango canonico contiene el codigo
+    for (int len = tableBits + 1; len <= table.maxLength; ++len) {
+        uint32_t index = reader.peek(len) - table.firstCode[len];
+        if (index < table.count[len]) {
+            reader.consume(len);
+            return table.sortedSymbols[table.offset[len] + index];
+        }
+    }
+    return -1;
+}
+
+void HuffmanCompressor::writeCodeLengths(std::vector<uint8_t>& out, const uint8_t* lengths, int count) {
+    // Codificacion compacta de las longitudes:
+    //   0x80 | (n - 1): n simbolos sin codigo (1..128)
+    //   0x40 | (n - 1): n repeticiones de la longitud anterior (1..64)
+    //   1..63:          longitud literal del siguiente simbolo
+    int i = 0;
+    uint8_t previous = 0;
+    while (i < count) {
+        int run = 1;
+        if (lengths[i] == 0) {
+            while (i + run < count && lengths[i + run] == 0 && run < 128) run++;
+            out.push_back(static_cast<uint8_t>(0x80 | (run - 1)));
+        } else if (lengths[i] == previous) {
+            while (i + run < count && lengths[i + run] == previous && run < 64) run++;
+            out.push_back(static_cast<uint8_t>(0x40 | (run - 1)));
+        } else {
+            out.push_back(lengths[i]);
+            previous = lengths[i];
+        }
+        i += run;
+    }
+}
+
+bool HuffmanCompressor::readCodeLengths(const uint8_t*& ptr, const uint8_t* end, uint8_t* lengths, int count) {
+    int i = 0;
+    uint8_t previous = 0;
+    while (i < count) {
+        if (ptr == end) return false;
+        uint8_t token = *ptr++;
+
+        int run = 1;
+        uint8_t value;
+        if (token & 0x80) {
+            run = (token & 0x7F) + 1;
+            value = 0;
+        } else if (token & 0x40) {
+            run = (token & 0x3F) + 1;
+            value = previous;
+            if (value == 0) return false;
+        } else {
+            value = token;
+            previous = value;
+        }
+
+        if (i + run > count) return false;
+        std::fill(lengths + i, lengths + i + run, value);
+        i += run;
+    }
+    return true;
+}
+
+template <typename Symbol>
+bool HuffmanCompressor::decodeSymbols(BitReader& reader, const DecodeTable& table, Symbol* out, size_t count) {
+    // Copias locales para que el estado del lector quede en registros
+    BitReader local = reader;
+    const DecodeEntry* fast = table.fast.data();
+
+    // Cada recarga deja al menos 56 bits: alcanza para varios simbolos
+    size_t perRefill = std::max(1, 56 / table.maxLength);
+    size_t i = 0;
+    bool ok = true;
+    while (ok && i + perRefill <= count) {
+        local.refill();
+        for (size_t j = 0; j < perRefill; ++j) {
+            int symbol = decodeSymbol(local, fast, table);
+            ok &= symbol >= 0;
+            out[i++] = static_cast<Symbol>(symbol);
+        }
+    }
+    for (; ok && i < count; ++i) {
+        local.refill();
+        int symbol = decodeSymbol(local, fast, table);
+        ok &= symbol >= 0;
+        out[i] = static_cast<Symbol>(symbol);
+    }
+
+    reader = local;
+    return ok;
+}
+
+bool HuffmanCompressor::decodeLzSymbols(BitReader& reader, const DecodeTable& literals,
+                                        const DecodeTable& distances, uint8_t* out, size_t size) {
+    BitReader local = reader;
+    const DecodeEntry* literalFast = literals.fast.data();
+    const DecodeEntry* distanceFast = distances.fast.data();
+
+    // Cada recarga deja al menos 56 bits: alcanza para un codigo (hasta 32)
+    // y sus bits extra (hasta 22)
+    size_t produced = 0;
+    while (produced < size) {
+        local.refill();
+        int symbol = decodeSymbol(local, literalFast, literals);
+        if (symbol < 0) return false;
+        if (symbol < 256) {
+            out[produced++] = static_cast<uint8_t>(symbol);
+            continue;
+        }
+
+        int code = symbol - 256;
+        int extra = Lz77::extraBits(code);
+        size_t length = Lz77::MIN_MATCH + Lz77::baseValue(code) + (extra > 0 ? local.read(extra) : 0);
+        if (distances.maxLength == 0) return false;
+        local.refill();
+        code = decodeSymbol(local, distanceFast, distances);
+        if (code < 0) return false;
+        extra = Lz77::extraBits(code);
+        size_t distance = 1 + Lz77::baseValue(code) + (extra > 0 ? local.read(extra) : 0);
+        if (distance > produced || length > size - produced) return false;
+
+        // Copia hacia adelante: con distancia menor que la longitud se
+        // repiten los bytes recien escritos
+        uint8_t* target = out + produced;
+        const uint8_t* source = target - distance;
+        if (distance >= length) {
+            std::memcpy(target, source, length);
+        } else {
+            for (size_t i = 0; i < length; ++i) target[i] = source[i];
+        }
+        produced += length;
+    }
+
+    reader = local;
+    return true;
+}
+
+bool HuffmanCompressor::decodeContextSymbols(BitReader& reader, const std::vector<DecodeTable>& tables,
+                                             const std::array<uint8_t, 256>& map, uint8_t* out, size_t count) {
+    // Tablas rapidas de todos los contextos en un solo arreglo, mas chicas
+    // que las de orden 0 para que entren juntas en la cache L1. Cada entrada
+    // guarda ademas donde empieza la tabla del simbolo siguiente, para que
+    // elegir la tabla no agregue accesos a la cadena de dependencias
+    struct Entry {
+        uint8_t symbol;
+        uint8_t length;
+        uint16_t next;
+    };
+    constexpr size_t TABLE_SIZE = size_t(1) << CONTEXT_TABLE_BITS;
+    std::vector<Entry> fast(tables.size() * TABLE_SIZE, Entry{0, 0, 0});
+    int maxLength = 1;
+    for (size_t t = 0; t < tables.size(); ++t) {
+        const DecodeTable& table = tables[t];
+        for (int len = 1; len <= std::min(table.maxLength, CONTEXT_TABLE_BITS); ++len) {
+            for (uint32_t k = 0; k < table.count[len]; ++k) {
+                uint8_t symbol = static_cast<uint8_t>(table.sortedSymbols[table.offset[len] + k]);
+                Entry entry = {symbol, static_cast<uint8_t>(len), static_cast<uint16_t>(map[symbol] * TABLE_SIZE)};
+                uint32_t first = (table.firstCode[len] + k) << (CONTEXT_TABLE_BITS - len);
+                std::fill_n(fast.begin() + t * TABLE_SIZE + first, size_t(1) << (CONTEXT_TABLE_BITS - len), entry);
+            }
+        }
+        maxLength = std::max(maxLength, table.maxLength);
+    }
+
+    BitReader local = reader;
+    size_t perRefill = std::max(1, 56 / maxLength);
+    size_t base = map[0] * TABLE_SIZE;
+    size_t i = 0;
+    bool ok = true;
+    auto decode = [&]() {
+        Entry entry = fast[base + local.peek(CONTEXT_TABLE_BITS)];
+        if (entry.length > 0) {
+            local.consume(entry.length);
+            base = entry.next;
+            return static_cast<int>(entry.symbol);
+        }
+        int symbol = decodeSlow(local, tables[base / TABLE_SIZE], CONTEXT_TABLE_BITS);
+        base = symbol >= 0 ? map[symbol] * TABLE_SIZE : 0;
+        return symbol;
+    };
+    while (ok && i + perRefill <= count) {
+        local.refill();
+        for (size_t j = 0; j < perRefill; ++j) {
+            int symbol = decode();
+            ok &= symbol >= 0;
+            out[i++] = static_cast<uint8_t>(symbol);
+        }
+    }
+    for (; ok && i < count; ++i) {
+        local.refill();
+        int symbol = decode();
+        ok &= symbol >= 0;
+        out[i] = static_cast<uint8_t>(symbol);
+    }
+
+    reader = local;
+    return ok;
+}
+
+uint64_t HuffmanCompressor::readLE(const uint8_t*& ptr, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        value |= (static_cast<uint64_t>(*ptr++) << (8 * i));
+    }
+    return value;
+}
+
+void HuffmanCompressor::putLE(std::vector<uint8_t>& out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<uint8_t>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void HuffmanCompressor::computeCodeLengths(const uint64_t* freq, int count, int maxCodeLength,
+                                           uint8_t* lengths, EncodeStats& stats) {
+    // Longitudes de Huffman sin construir el arbol; los codigos se asignan
+    // de forma canonica
+    huffmanCodeLengths(freq, count, lengths);
+
+    // Limitar la longitud de los codigos (nunca por debajo de lo necesario
+    // para representar todos los simbolos)
+    int symbolCount = 0;
+    int longest = 0;
+    uint64_t optimalBits = 0;
+    for (int i = 0; i < count; ++i) {
+        if (freq[i] > 0) symbolCount++;
+        longest = std::max<int>(longest, lengths[i]);
+        optimalBits += freq[i] * lengths[i];
+    }
+    int minLength = 1;
+    while ((1 << minLength) < symbolCount) minLength++;
+    int maxLength = std::clamp(maxCodeLength, minLength, MAX_CODE_LENGTH);
+
+    uint64_t encodedBits = optimalBits;
+    if (longest > maxLength) {
+        limitCodeLengths(freq, count, maxLength, lengths);
+        encodedBits = 0;
+        for (int i = 0; i < count; ++i) encodedBits += freq[i] * lengths[i];
+        stats.limitedBlocks++;
+    }
+
+    stats.optimalBits += optimalBits;
+    stats.encodedBits += encodedBits;
+    stats.longestCode = std::max(stats.longestCode, longest);
+}
+
+size_t HuffmanCompressor::codeLengthsSize(const uint8_t* lengths, int count) {
+    // Se codifican en un buffer reutilizado por hilo solo para medirlas
+    thread_local std::vector<uint8_t> scratch;
+    scratch.clear();
+    writeCodeLengths(scratch, lengths, count);
+    return scratch.size();
+}
+
+size_t HuffmanCompressor::buildContextModel(const std::array<uint32_t, 256>* counts, int maxCodeLength,
+                                            ContextModel& model, EncodeStats& stats) {
+    // Contextos presentes, del mas al menos frecuente, y los simbolos que
+    // aparecen en cada uno (lista compacta para medir costos)
+    std::array<uint64_t, 256> total{};
+    std::array<uint8_t, 256> order;
+    std::array<uint32_t, 257> pairStart{};
+    std::vector<uint8_t> pairSymbol;
+    int contexts = 0;
+    for (int c = 0; c < 256; ++c) {
+        pairStart[c] = static_cast<uint32_t>(pairSymbol.size());
+        for (int symbol = 0; symbol < 256; ++symbol) {
+            if (counts[c][symbol] == 0) continue;
+            total[c] += counts[c][symbol];
+            pairSymbol.push_back(static_cast<uint8_t>(symbol));
+        }
+        if (total[c] > 0) order[contexts++] = static_cast<uint8_t>(c);
+    }
+    pairStart[256] = static_cast<uint32_t>(pairSymbol.size());
+    std::sort(order.begin(), order.begin() + contexts, [&total](uint8_t a, uint8_t b) {
+        return total[a] > total[b] || (total[a] == total[b] && a < b);
+    });
+
+    // Punto de partida: los contextos mas frecuentes tienen tabla propia y el
+    // resto comparte la tabla 0. Un contexto con pocos simbolos no paga su tabla.
+    constexpr uint64_t MIN_CONTEXT_SYMBOLS = 2048;
+    int tables = 1;
+    model.map.fill(0);
+    for (int i = 0; i < contexts && tables < CONTEXT_TABLES && total[order[i]] >= MIN_CONTEXT_SYMBOLS; ++i) {
+        model.map[order[i]] = static_cast<uint8_t>(tables++);
+    }
+    if (tables == 1) return SIZE_MAX;
+
+    // Refinamiento: cada contexto pasa a la tabla que lo codifica con menos
+    // bits y las tablas se recalculan con sus nuevos contextos
+    constexpr int REFINE_PASSES = 2;
+    std::array<std::array<uint64_t, 256>, CONTEXT_TABLES> freq;
+    EncodeStats scratch;
+    for (int pass = 0; ; ++pass) {
+        for (int t = 0; t < tables; ++t) freq[t].fill(0);
+        for (int i = 0; i < contexts; ++i) {
+            int c = order[i];
+            for (uint32_t k = pairStart[c]; k < pairStart[c + 1]; ++k) {
+                freq[model.map[c]][pairSymbol[k]] += counts[c][pairSymbol[k]];
+            }
+        }
+
+        // Las tablas que quedaron sin contextos se eliminan
+        std::array<int, CONTEXT_TABLES> renumber;
+        int used = 0;
+        for (int t = 0; t < tables; ++t) {
+            bool empty = std::all_of(freq[t].begin(), freq[t].end(), [](uint64_t f) { return f == 0; });
+            renumber[t] = used;
+            if (!empty) freq[used++] = freq[t];
+        }
+        for (int i = 0; i < contexts; ++i) model.map[order[i]] = static_cast<uint8_t>(renumber[model.map[order[i]]]);
+        tables = used;
+
+        bool last = pass == REFINE_PASSES;
+        for (int t = 0; t < tables; ++t) {
+            computeCodeLengths(freq[t].data(), 256, maxCodeLength, model.lengths[t].data(), last ? stats : scratch);
+        }
+        if (last) break;
+
+        for (int i = 0; i < contexts; ++i) {
+            int c = order[i];
+            uint64_t bestCost = UINT64_MAX;
+            for (int t = 0; t < tables; ++t) {
+                const uint8_t* lengths = model.lengths[t].data();
+                uint64_t cost = 0;
+                for (uint32_t k = pairStart[c]; k < pairStart[c + 1] && cost < bestCost; ++k) {
+                    uint8_t symbol = pairSymbol[k];
+                    cost = lengths[symbol] ? cost + uint64_t(counts[c][symbol]) * lengths[symbol] : UINT64_MAX;
+                }
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    model.map[c] = static_cast<uint8_t>(t);
+                }
+            }
+        }
+    }
+    model.tableCount = tables;
+
+    // Tamanio del payload: cantidad de tablas, mapa de contextos, longitudes y datos
+    uint64_t bits = 0;
+    size_t tableBytes = 0;
+    for (int t = 0; t < tables; ++t) {
+        for (int symbol = 0; symbol < 256; ++symbol) bits += freq[t][symbol] * model.lengths[t][symbol];
+        tableBytes += codeLengthsSize(model.lengths[t].data(), 256);
+    }
+    return 1 + 128 + tableBytes + static_cast<size_t>((bits + 7) / 8);
+}
+
+uint64_t HuffmanCompressor::encodeBwtPayload(const uint8_t* data, size_t size, int maxCodeLength,
+                                             std::vector<uint8_t>& out, EncodeStats& stats) {
+    Stats& phases = stats.phases;
+
+    // BWT del bloque y move-to-front con corridas de ceros
+    std::vector<uint16_t> symbols;
+    uint32_t primary;
+    {
+        PhaseTimer timer(phases, phases.transform);
+        std::vector<uint8_t> transformed(size);
+        primary = Bwt::forward(data, size, transformed.data());
+        Bwt::encodeMtf(transformed.data(), size, symbols);
+    }
+
+    std::array<uint64_t, Bwt::ALPHABET> freq{};
+    {
+        PhaseTimer timer(phases, phases.histogram);
+        for (uint16_t symbol : symbols) freq[symbol]++;
+    }
+    std::array<uint8_t, Bwt::ALPHABET> lengths{};
+    {
+        PhaseTimer timer(phases, phases.tree);
+        computeCodeLengths(freq.data(), Bwt::ALPHABET, maxCodeLength, lengths.data(), stats);
+    }
+    std::array<Code, Bwt::ALPHABET> codes{};
+    {
+        PhaseTimer timer(phases, phases.codes);
+        assignCanonicalCodes(lengths.data(), Bwt::ALPHABET, codes.data());
+    }
+
+    // Fila del centinela, cantidad de simbolos, longitudes y un unico flujo
+    PhaseTimer timer(phases, phases.encode);
+    putLE(out, primary, 4);
+    putLE(out, symbols.size(), 4);
+    writeCodeLengths(out, lengths.data(), Bwt::ALPHABET);
+    BitWriter writer(out);
+    for (uint16_t symbol : symbols) {
+        writer.write(codes[symbol].bits, codes[symbol].length);
+    }
+    writer.flush();
+    return writer.bitsWritten();
+}
+
+uint64_t HuffmanCompressor::encodeLzPayload(const uint8_t* data, size_t size, const CompressOptions& options,
+                                            std::vector<uint8_t>& out, EncodeStats& stats) {
+    Stats& phases = stats.phases;
+
+    std::vector<Lz77::Token> tokens;
+    {
+        PhaseTimer timer(phases, phases.transform);
+        Lz77::parse(data, size, options.lzLevel, options.lzWindow, tokens);
+    }
+
+    // Frecuencias de literales/longitudes y de distancias
+    std::array<uint64_t, Lz77::LITERAL_ALPHABET> literalFreq{};
+    std::array<uint64_t, Lz77::DISTANCE_CODES> distanceFreq{};
+    {
+        PhaseTimer timer(phases, phases.histogram);
+        for (const Lz77::Token& token : tokens) {
+            if (token.distance == 0) {
+                literalFreq[token.length]++;
+            } else {
+                literalFreq[256 + Lz77::valueCode(token.length - Lz77::MIN_MATCH)]++;
+                distanceFreq[Lz77::valueCode(token.distance - 1)]++;
+            }
+        }
+    }
+    std::array<uint8_t, Lz77::LITERAL_ALPHABET> literalLengths{};
+    std::array<uint8_t, Lz77::DISTANCE_CODES> distanceLengths{};
+    {
+        PhaseTimer timer(phases, phases.tree);
+        computeCodeLengths(literalFreq.data(), Lz77::LITERAL_ALPHABET, options.maxCodeLength,
+                           literalLengths.data(), stats);
+        computeCodeLengths(distanceFreq.data(), Lz77::DISTANCE_CODES, options.maxCodeLength,
+                           distanceLengths.data(), stats);
+    }
+    std::array<Code, Lz77::LITERAL_ALPHABET> literalCodes{};
+    std::array<Code, Lz77::DISTANCE_CODES> distanceCodes{};
+    {
+        PhaseTimer timer(phases, phases.codes);
+        assignCanonicalCodes(literalLengths.data(), Lz77::LITERAL_ALPHABET, literalCodes.data());
+        assignCanonicalCodes(distanceLengths.data(), Lz77::DISTANCE_CODES, distanceCodes.data());
+    }
+
+    // Longitudes de ambos alfabetos y un unico flujo: cada coincidencia es
+    // el codigo de su longitud, sus bits extra, el de su distancia y los suyos
+    PhaseTimer timer(phases, phases.encode);
+    writeCodeLengths(out, literalLengths.data(), Lz77::LITERAL_ALPHABET);
+    writeCodeLengths(out, distanceLengths.data(), Lz77::DISTANCE_CODES);
+    BitWriter writer(out);
+    for (const Lz77::Token& token : tokens) {
+        if (token.distance == 0) {
+            writer.write(literalCodes[token.length].bits, literalCodes[token.length].length);
+            continue;
+        }
+        uint32_t length = token.length - Lz77::MIN_MATCH;
+        int code = Lz77::valueCode(length);
+        writer.write(literalCodes[256 + code].bits, literalCodes[256 + code].length);
+        writer.write(length - Lz77::baseValue(code), Lz77::extraBits(code));
+
+        uint32_t distance = token.distance - 1;
+        code = Lz77::valueCode(distance);
+        writer.write(distanceCodes[code].bits, distanceCodes[code].length);
+        writer.write(distance - Lz77::baseValue(code), Lz77::extraBits(code));
+    }
+    writer.flush();
+    return writer.bitsWritten();
+}
+
+uint64_t HuffmanCompressor::encodeStored(const uint8_t* data, size_t size, std::vector<uint8_t>& out,
+                                         EncodeStats& stats) {
+    // Payload: los datos sin codificar
+    PhaseTimer timer(stats.phases, stats.phases.encode);
+    out.push_back(BLOCK_STORED);
+    putLE(out, size, 4);
+    putLE(out, size, 4);
+    out.insert(out.end(), data, data + size);
+
+    uint64_t bits = static_cast<uint64_t>(size) * 8;
+    stats.optimalBits += bits;
+    stats.encodedBits += bits;
+    stats.storedBlocks++;
+    return bits;
+}
+
+// Codigos de orden 0 en un solo flujo. Cada 'interval' bytes (0 = nunca)
+// anota la posicion en bits: ahi el decodificador esta entre dos simbolos.
+void HuffmanCompressor::encodeSymbols(const uint8_t* data, size_t size, const Code* codes, size_t interval,
+                                      BitWriter& writer, std::vector<uint32_t>& checkpoints) {
+    size_t step = interval > 0 ? interval : size;
+    for (size_t start = 0; start < size; start += step) {
+        if (start > 0) checkpoints.push_back(static_cast<uint32_t>(writer.bitsWritten()));
+        size_t stop = std::min(size, start + step);
+        for (size_t i = start; i < stop; ++i) {
+            const Code& code = codes[data[i]];
+            writer.write(code.bits, code.length);
+        }
+    }
+}
+
+uint64_t HuffmanCompressor::encodeBlock(const uint8_t* data, size_t size, const CompressOptions& options,
+                                        std::vector<uint8_t>& out, std::vector<uint32_t>& checkpoints,
+                                        EncodeStats& stats, unsigned countThreads) {
+    Stats& phases = stats.phases;
+    phases.hardwareCounters = options.hardwareCounters;
+    checkpoints.clear();
+
+    // Con diccionario no hacen falta histograma ni tabla: el payload es solo
+    // el flujo de bits con los codigos entrenados
+    if (options.dictionary) {
+        size_t blockStart = out.size();
+        uint64_t bits;
+        {
+            PhaseTimer timer(phases, phases.encode);
+            out.push_back(BLOCK_DICTIONARY);
+            putLE(out, size, 4);
+            putLE(out, 0, 4);
+            BitWriter writer(out);
+            encodeSymbols(data, size, options.dictionary->codes.data(), options.checkpointInterval, writer,
+                          checkpoints);
+            writer.flush();
+            bits = writer.bitsWritten();
+        }
+
+        // Datos que no se parecen a los del entrenamiento pueden crecer
+        uint64_t payloadSize = out.size() - blockStart - 9;
+        if (payloadSize >= size) {
+            out.resize(blockStart);
+            checkpoints.clear();
+            return encodeStored(data, size, out, stats);
+        }
+        for (size_t i = 0; i < 4; ++i) {
+            out[blockStart + 5 + i] = static_cast<uint8_t>(payloadSize >> (8 * i));
+        }
+        stats.optimalBits += bits;
+        stats.encodedBits += bits;
+        return bits;
+    }
+
+    // Datos ya comprimidos (ZIP, JPG...): si solo se usaria el codigo de
+    // orden 0, una muestra basta para descartar los bloques grandes
+    bool orderZeroOnly = !options.contextModel && options.lzLevel == 0 && !options.bwt;
+    std::array<uint64_t, 256> freq{};
+    if (orderZeroOnly && size >= SAMPLE_MIN_BLOCK) {
+        bool incompressible;
+        {
+            PhaseTimer timer(phases, phases.histogram);
+            Histogram::countSample(data, size, freq);
+            incompressible = Histogram::entropy(freq) > INCOMPRESSIBLE_ENTROPY;
+        }
+        if (incompressible) return encodeStored(data, size, out, stats);
+    }
+
+    // Construir tabla de frecuencias (y las de orden 1 si se pide el modelo
+    // de contexto)
+    std::vector<std::array<uint32_t, 256>> contextCounts;
+    bool incompressible = false;
+    {
+        PhaseTimer timer(phases, phases.histogram);
+        Histogram::count(data, size, freq, countThreads);
+        if (options.contextModel) {
+            contextCounts.resize(256);
+            Histogram::countContexts(data, size, contextCounts.data());
+        }
+        incompressible = orderZeroOnly && Histogram::entropy(freq) > INCOMPRESSIBLE_ENTROPY;
+    }
+    if (incompressible) return encodeStored(data, size, out, stats);
+
+    // Con el modelo de contexto se usa el que da el bloque mas chico
+    std::array<uint8_t, 256> lengths{};
+    ContextModel model;
+    bool useContext = false;
+    EncodeStats chosen;
+    size_t chosenSize;
+    {
+        PhaseTimer timer(phases, phases.tree);
+        computeCodeLengths(freq.data(), 256, options.maxCodeLength, lengths.data(), chosen);
+        chosenSize = codeLengthsSize(lengths.data(), 256) + (chosen.encodedBits + 7) / 8;
+        if (options.contextModel) {
+            EncodeStats context;
+            size_t contextSize = buildContextModel(contextCounts.data(), options.maxCodeLength, model, context);
+            useContext = contextSize < chosenSize;
+            if (useContext) {
+                chosen = context;
+                chosenSize = contextSize;
+            }
+        }
+    }
+
+    // Con LZ77 o BWT el bloque se escribe completo y se descarta si no
+    // resulta mas chico que el elegido hasta aca
+    size_t candidateStart = out.size();
+    uint64_t candidateBits = 0;
+    bool useCandidate = false;
+    auto tryCandidate = [&](BlockType type, auto encodePayload) {
+        size_t blockStart = out.size();
+        out.push_back(type);
+        putLE(out, size, 4);
+        putLE(out, 0, 4);
+        EncodeStats transformed;
+        transformed.phases.hardwareCounters = options.hardwareCounters;
+        uint64_t bits = encodePayload(transformed);
+        phases.merge(transformed.phases);
+
+        uint64_t payloadSize = out.size() - blockStart - 9;
+        if (payloadSize >= chosenSize) {
+            out.resize(blockStart);
+            return;
+        }
+        for (size_t i = 0; i < 4; ++i) {
+            out[blockStart + 5 + i] = static_cast<uint8_t>(payloadSize >> (8 * i));
+        }
+        if (useCandidate) out.erase(out.begin() + candidateStart, out.begin() + blockStart);
+        useCandidate = true;
+        candidateBits = bits;
+        chosen = transformed;
+        chosenSize = payloadSize;
+    };
+    if (options.lzLevel > 0 && size > 0) {
+        tryCandidate(BLOCK_LZ77, [&](EncodeStats& transformed) {
+            return encodeLzPayload(data, size, options, out, transformed);
+        });
+    }
+    if (options.bwt && size > 0) {
+        tryCandidate(BLOCK_BWT, [&](EncodeStats& transformed) {
+            return encodeBwtPayload(data, size, options.maxCodeLength, out, transformed);
+        });
+    }
+
+    // Si ni asi achica se guarda tal cual. Con varios flujos el tamanio
+    // estimado no incluye sus tamanios ni el relleno de cada uno.
+    int streams = (options.streams == 4 || options.streams == 8) && !useContext ? options.streams : 1;
+    size_t worstSize = chosenSize;
+    if (!useCandidate && streams > 1) worstSize += 1 + 5 * (streams - 1);
+    if (worstSize >= size) {
+        out.resize(candidateStart);
+        return encodeStored(data, size, out, stats);
+    }
+
+    stats.optimalBits += chosen.optimalBits;
+    stats.encodedBits += chosen.encodedBits;
+    stats.longestCode = std::max(stats.longestCode, chosen.longestCode);
+    stats.limitedBlocks += chosen.limitedBlocks > 0 ? 1 : 0;
+    if (useCandidate) return candidateBits;
+
+    std::array<Code, 256> codes{};
+    std::array<std::array<Code, 256>, CONTEXT_TABLES> contextCodes;
+    {
+        PhaseTimer timer(phases, phases.codes);
+        if (useContext) {
+            for (int t = 0; t < model.tableCount; ++t) {
+                assignCanonicalCodes(model.lengths[t].data(), 256, contextCodes[t].data());
+            }
+        } else {
+            assignCanonicalCodes(lengths.data(), 256, codes.data());
+        }
+    }
+    PhaseTimer timer(phases, phases.encode);
+
+    // Cabecera del bloque; el tamanio del payload se completa al final.
+    // Los bloques con contexto usan un solo flujo: cada simbolo depende del
+    // anterior, por lo que intercalar flujos no adelanta la decodificacion
+    out.push_back(useContext ? BLOCK_HUFFMAN_CONTEXT : streams > 1 ? BLOCK_HUFFMAN_MULTI : BLOCK_HUFFMAN);
+    putLE(out, size, 4);
+    size_t sizeField = out.size();
+    putLE(out, 0, 4);
+    size_t payloadStart = out.size();
+
+    // Codificar datos: acumulador de 64 bits volcado al buffer del bloque
+    uint64_t bits = 0;
+    if (useContext) {
+        // Cantidad de tablas, tabla de cada contexto (4 bits) y longitudes
+        out.push_back(static_cast<uint8_t>(model.tableCount));
+        for (int c = 0; c < 256; c += 2) {
+            out.push_back(static_cast<uint8_t>(model.map[c] | (model.map[c + 1] << 4)));
+        }
+        for (int t = 0; t < model.tableCount; ++t) {
+            writeCodeLengths(out, model.lengths[t].data(), 256);
+        }
+
+        std::array<const Code*, 256> byContext;
+        for (int c = 0; c < 256; ++c) byContext[c] = contextCodes[model.map[c]].data();
+        BitWriter writer(out);
+        uint8_t previous = 0;
+        for (size_t i = 0; i < size; ++i) {
+            const Code& code = byContext[previous][data[i]];
+            writer.write(code.bits, code.length);
+            previous = data[i];
+        }
+        writer.flush();
+        bits = writer.bitsWritten();
+    } else if (streams == 1) {
+        writeCodeLengths(out, lengths.data(), 256);
+        BitWriter writer(out);
+        encodeSymbols(data, size, codes.data(), options.checkpointInterval, writer, checkpoints);
+        writer.flush();
+        bits = writer.bitsWritten();
+    } else {
+        // Varios flujos intercalados: el simbolo i va al flujo i % streams.
+        // Se escribe el numero de flujos y el tamanio de todos menos el ultimo.
+        writeCodeLengths(out, lengths.data(), 256);
+        std::vector<std::vector<uint8_t>> parts(streams);
+        std::vector<BitWriter> writers;
+        writers.reserve(streams);
+        for (std::vector<uint8_t>& part : parts) {
+            part.reserve(size / streams + 64);
+            writers.emplace_back(part);
+        }
+        size_t i = 0;
+        for (; i + streams <= size; i += streams) {
+            for (int k = 0; k < streams; ++k) {
+                const Code& code = codes[data[i + k]];
+                writers[k].write(code.bits, code.length);
+            }
+        }
+        for (int k = 0; i < size; ++i, ++k) {
+            const Code& code = codes[data[i]];
+            writers[k].write(code.bits, code.length);
+        }
+
+        out.push_back(static_cast<uint8_t>(streams));
+        for (int k = 0; k < streams; ++k) {
+            writers[k].flush();
+            bits += writers[k].bitsWritten();
+            if (k < streams - 1) putLE(out, parts[k].size(), 4);
+        }
+        for (const std::vector<uint8_t>& part : parts) {
+            out.insert(out.end(), part.begin(), part.end());
+        }
+    }
+
+    uint64_t payloadSize = out.size() - payloadStart;
+    for (size_t i = 0; i < 4; ++i) {
+        out[sizeField + i] = static_cast<uint8_t>(payloadSize >> (8 * i));
+    }
+    return bits;
+}
+
+template <int N>
+bool HuffmanCompressor::decodeInterleaved(const uint8_t* const* starts, const size_t* sizes,
+                                          const DecodeTable& table, uint8_t* out, size_t count) {
+    // N lectores independientes en el mismo bucle: las cadenas de dependencia
+    // de cada flujo se solapan
+    BitReader readers[N];
+    for (int k = 0; k < N; ++k) {
+        readers[k] = BitReader(starts[k], sizes[k]);
+    }
+    const DecodeEntry* fast = table.fast.data();
+
+    // Cada lector decodifica 'perRefill' simbolos por recarga
+    size_t perRefill = std::max(1, 56 / table.maxLength);
+    size_t step = perRefill * N;
+    size_t i = 0;
+    bool ok = true;
+    while (ok && i + step <= count) {
+        for (int k = 0; k < N; ++k) readers[k].refill();
+        for (size_t j = 0; j < perRefill; ++j) {
+            for (int k = 0; k < N; ++k) {
+                int symbol = decodeSymbol(readers[k], fast, table);
+                ok &= symbol >= 0;
+                out[i + k] = static_cast<uint8_t>(symbol);
+            }
+            i += N;
+        }
+    }
+    for (; ok && i < count; ++i) {
+        BitReader& reader = readers[i % N];
+        reader.refill();
+        int symbol = decodeSymbol(reader, fast, table);
+        ok &= symbol >= 0;
+        out[i] = static_cast<uint8_t>(symbol);
+    }
+
+    for (int k = 0; k < N; ++k) {
+        ok &= readers[k].bitsConsumed() <= static_cast<uint64_t>(sizes[k]) * 8;
+    }
+    return ok;
+}
+
+bool HuffmanCompressor::decodeBlock(int type, const uint8_t* payload, size_t payloadSize,
+                                    uint8_t* out, size_t rawSize, const Dictionary* dictionary, Stats& stats) {
+    const uint8_t* ptr = payload;
+    const uint8_t* end = payload + payloadSize;
+
+    if (type == BLOCK_STORED) {
+        if (payloadSize != rawSize) return false;
+        PhaseTimer timer(stats, stats.decode);
+        std::memcpy(out, payload, rawSize);
+        return true;
+    }
+
+    if (type == BLOCK_DICTIONARY) {
+        // Solo el flujo de bits: la tabla es la del diccionario
+        if (!dictionary) return false;
+        PhaseTimer timer(stats, stats.decode);
+        BitReader reader(ptr, end - ptr);
+        if (!decodeSymbols(reader, dictionary->table, out, rawSize)) return false;
+        return reader.bitsConsumed() <= static_cast<uint64_t>(end - ptr) * 8;
+    }
+
+    if (type == BLOCK_LZ77) {
+        // Longitudes de literales/longitudes y de distancias; sin
+        // coincidencias la tabla de distancias queda vacia
+        std::array<uint8_t, Lz77::LITERAL_ALPHABET> literalLengths{};
+        std::array<uint8_t, Lz77::DISTANCE_CODES> distanceLengths{};
+        DecodeTable literals;
+        DecodeTable distances;
+        bool valid;
+        {
+            PhaseTimer timer(stats, stats.codes);
+            valid = readCodeLengths(ptr, end, literalLengths.data(), Lz77::LITERAL_ALPHABET) &&
+                    readCodeLengths(ptr, end, distanceLengths.data(), Lz77::DISTANCE_CODES) &&
+                    buildCanonicalDecodeTable(literalLengths.data(), Lz77::LITERAL_ALPHABET, literals);
+            bool matches = std::any_of(distanceLengths.begin(), distanceLengths.end(),
+                                       [](uint8_t length) { return length > 0; });
+            valid = valid && (!matches ||
+                              buildCanonicalDecodeTable(distanceLengths.data(), Lz77::DISTANCE_CODES, distances));
+        }
+        if (!valid) return false;
+
+        PhaseTimer timer(stats, stats.decode);
+        BitReader reader(ptr, end - ptr);
+        if (!decodeLzSymbols(reader, literals, distances, out, rawSize)) return false;
+        return reader.bitsConsumed() <= static_cast<uint64_t>(end - ptr) * 8;
+    }
+
+    if (type == BLOCK_BWT) {
+        // Fila del centinela, cantidad de simbolos y longitudes del alfabeto
+        // de move-to-front
+        if (end - ptr < 8) return false;
+        uint32_t primary = static_cast<uint32_t>(readLE(ptr, 4));
+        size_t symbolCount = static_cast<size_t>(readLE(ptr, 4));
+        if (primary == 0 || primary > rawSize || symbolCount == 0 || symbolCount > rawSize) return false;
+
+        std::array<uint8_t, Bwt::ALPHABET> lengths{};
+        DecodeTable table;
+        bool valid;
+        {
+            PhaseTimer timer(stats, stats.codes);
+            valid = readCodeLengths(ptr, end, lengths.data(), Bwt::ALPHABET) &&
+                    buildCanonicalDecodeTable(lengths.data(), Bwt::ALPHABET, table);
+        }
+        if (!valid) return false;
+
+        std::vector<uint16_t> symbols(symbolCount);
+        {
+            PhaseTimer timer(stats, stats.decode);
+            BitReader reader(ptr, end - ptr);
+            if (!decodeSymbols(reader, table, symbols.data(), symbolCount) ||
+                reader.bitsConsumed() > static_cast<uint64_t>(end - ptr) * 8) {
+                return false;
+            }
+        }
+
+        PhaseTimer timer(stats, stats.transform);
+        std::vector<uint8_t> transformed(rawSize);
+        return Bwt::decodeMtf(symbols.data(), symbolCount, transformed.data(), rawSize) &&
+               Bwt::inverse(transformed.data(), rawSize, primary, out);
+    }
+
+    if (type == BLOCK_HUFFMAN_CONTEXT) {
+        // Cantidad de tablas, tabla de cada contexto y longitudes de cada tabla
+        std::array<uint8_t, 256> map;
+        std::vector<DecodeTable> tables;
+        bool valid = end - ptr > 129;
+        {
+            PhaseTimer timer(stats, stats.codes);
+            int tableCount = valid ? *ptr++ : 0;
+            valid = valid && tableCount >= 1 && tableCount <= CONTEXT_TABLES;
+            for (int c = 0; valid && c < 256; c += 2) {
+                map[c] = *ptr & 0x0F;
+                map[c + 1] = *ptr++ >> 4;
+                valid = map[c] < tableCount && map[c + 1] < tableCount;
+            }
+            if (valid) tables.resize(tableCount);
+            std::array<uint8_t, 256> lengths{};
+            for (DecodeTable& table : tables) {
+                valid = valid && readCodeLengths(ptr, end, lengths.data(), 256) &&
+                        buildCanonicalDecodeTable(lengths.data(), 256, table);
+            }
+        }
+        if (!valid) return false;
+
+        PhaseTimer timer(stats, stats.decode);
+        BitReader reader(ptr, end - ptr);
+        if (!decodeContextSymbols(reader, tables, map, out, rawSize)) return false;
+        return reader.bitsConsumed() <= static_cast<uint64_t>(end - ptr) * 8;
+    }
+
+    std::array<uint8_t, 256> lengths{};
+    DecodeTable table;
+    bool valid;
+    {
+        PhaseTimer timer(stats, stats.codes);
+        valid = readCodeLengths(ptr, end, lengths.data(), 256) &&
+                buildCanonicalDecodeTable(lengths.data(), 256, table);
+    }
+    if (!valid) return false;
+
+    PhaseTimer timer(stats, stats.decode);
+
+    if (type == BLOCK_HUFFMAN) {
+        BitReader reader(ptr, end - ptr);
+        if (!decodeSymbols(reader, table, out, rawSize)) return false;
+        return reader.bitsConsumed() <= static_cast<uint64_t>(end - ptr) * 8;
+    }
+
+    // Flujos intercalados: numero de flujos y tabla de saltos
+    if (ptr == end) return false;
+    int streams = *ptr++;
+    if ((streams != 4 && streams != 8) || static_cast<size_t>(end - ptr) < size_t(streams - 1) * 4) {
+        return false;
+    }
+
+    const uint8_t* starts[8];
+    size_t sizes[8];
+    const uint8_t* data = ptr + (streams - 1) * 4;
+    for (int k = 0; k < streams; ++k) {
+        sizes[k] = k < streams - 1 ? static_cast<size_t>(readLE(ptr, 4)) : static_cast<size_t>(end - data);
+        if (sizes[k] > static_cast<size_t>(end - data)) return false;
+        starts[k] = data;
+        data += sizes[k];
+    }
+
+    return streams == 4 ? decodeInterleaved<4>(starts, sizes, table, out, rawSize)
+                        : decodeInterleaved<8>(starts, sizes, table, out, rawSize);
 }
 
-void HuffmanCompressor::writeLE(std::ostream& out, uint64_t value, size_t bytes) {
-    for (size_t i = 0; i < bytes; ++i) {
-        out.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+const char* statusMessage(Status status) {
+    switch (status) {
+        case Status::Ok: return "Operacion completada";
+        case Status::OpenFailed: return "No se pudo abrir el archivo de entrada";
+        case Status::CreateFailed: return "No se pudo crear el archivo de salida";
+        case Status::WriteFailed: return "No se pudo escribir la salida";
+        case Status::ReadFailed: return "No se pudo leer la entrada";
+        case Status::InvalidFormat: return "Formato de archivo invalido";
+        case Status::CorruptHeader: return "Cabecera del archivo corrupta";
+        case Status::CorruptData: return "Datos comprimidos corruptos";
+        case Status::CorruptIndex: return "Indice de bloques corrupto";
+        case Status::OutputTooSmall: return "El buffer de salida es demasiado chico";
+        case Status::DictionaryMismatch: return "Falta el diccionario con que se comprimio o no coincide";
+        case Status::ChecksumMismatch: return "Los datos descomprimidos no coinciden con su CRC32C";
+        case Status::DuplicateMember: return "Dos archivos distintos tendrian la misma ruta en el paquete";
     }
+    return "Error desconocido";
 }
 
-uint64_t HuffmanCompressor::readLE(std::istream& in, size_t bytes) {
-    uint64_t value = 0;
-    for (size_t i = 0; i < bytes; ++i) {
-        int byte = in.get();
-        if (byte == EOF) return UINT64_MAX;
-        value |= (static_cast<uint64_t>(byte) << (8 * i));
+size_t HuffmanCompressor::compressBound(size_t size, const CompressOptions& options) {
+    size_t blockSize = std::clamp<size_t>(options.blockSize, MIN_BLOCK_SIZE, MAX_BLOCK_SIZE);
+    uint64_t blocks = std::max<uint64_t>((size + blockSize - 1) / blockSize, 1);
+
+    // Un bloque que no achica se guarda tal cual: en el peor caso los datos
+    // mas la cabecera (con el id del diccionario) y tipo, tamanios y CRC de
+    // cada bloque
+    uint64_t bound = 9 + (options.dictionary ? 4 : 0) + blocks * (options.blockChecksum ? 13 : 9) + size;
+
+    // Fin de bloques, CRC de la entrada, puntos de control (a lo sumo uno
+    // por intervalo y una cantidad por bloque) e indice
+    bound += 1 + (options.streamChecksum ? 4 : 0);
+    if (options.writeIndex) bound += blocks * 20 + 8;
+    if (options.writeIndex && options.checkpointInterval > 0) {
+        size_t interval = std::clamp(options.checkpointInterval, MIN_CHECKPOINT_INTERVAL, blockSize);
+        bound += 12 + blocks * 4 + (size / interval) * 4;
     }
-    return value;
+    return static_cast<size_t>(bound);
 }
 
-bool HuffmanCompressor::compress(const std::string& inputPath, const std::string& outputPath) {
-    std::cout << "\nIniciando compresion...\n";
-    
-    // Abrir archivo de entrada
-    std::ifstream input(inputPath, std::ios::binary);
-    if (!input) {
-        std::cerr << "Error: No se pudo abrir el archivo: " << inputPath << "\n";
-        return false;
+uint32_t HuffmanCompressor::dictionaryId(const std::array<uint8_t, 256>& lengths) {
+    // FNV-1a de las longitudes: la misma tabla da siempre el mismo id
+    uint32_t hash = 2166136261u;
+    for (uint8_t length : lengths) {
+        hash = (hash ^ length) * 16777619u;
     }
+    return hash;
+}
 
-    // Leer datos
-    std::vector<uint8_t> data;
-    char byte;
-    while (input.get(byte)) {
-        data.push_back(static_cast<uint8_t>(byte));
+void HuffmanCompressor::buildDictionary(const std::array<uint64_t, 256>& freq, int maxCodeLength,
+                                        Dictionary& dictionary) {
+    // Cada byte cuenta al menos una vez para que todos tengan codigo
+    std::array<uint64_t, 256> smoothed;
+    for (int i = 0; i < 256; ++i) smoothed[i] = freq[i] + 1;
+
+    EncodeStats unused;
+    computeCodeLengths(smoothed.data(), 256, maxCodeLength, dictionary.lengths.data(), unused);
+    assignCanonicalCodes(dictionary.lengths.data(), 256, dictionary.codes.data());
+    buildCanonicalDecodeTable(dictionary.lengths.data(), 256, dictionary.table);
+    dictionary.id = dictionaryId(dictionary.lengths);
+}
+
+void HuffmanCompressor::trainDictionary(const uint8_t* data, size_t size, Dictionary& dictionary,
+                                        int maxCodeLength) {
+    std::array<uint64_t, 256> freq{};
+    Histogram::count(data, size, freq);
+    buildDictionary(freq, maxCodeLength, dictionary);
+}
+
+Status HuffmanCompressor::trainDictionary(const std::vector<std::string>& samplePaths, Dictionary& dictionary,
+                                          int maxCodeLength) {
+    // Frecuencias sumadas de todas las muestras
+    std::array<uint64_t, 256> total{};
+    for (const std::string& path : samplePaths) {
+        InputFile input;
+        if (!input.open(path)) return Status::OpenFailed;
+        std::vector<uint8_t> buffer;
+        size_t length = 0;
+        while (const uint8_t* chunk = input.next(InputFile::READ_BUFFER_SIZE, buffer, length)) {
+            if (length == 0) break;
+            std::array<uint64_t, 256> freq;
+            Histogram::count(chunk, length, freq);
+            for (int i = 0; i < 256; ++i) total[i] += freq[i];
+        }
+        if (input.failed()) return Status::ReadFailed;
     }
-    input.close();
+    buildDictionary(total, maxCodeLength, dictionary);
+    return Status::Ok;
+}
 
-    if (data.empty()) {
-        std::cerr << "Error: El archivo esta vacio.\n";
-        return false;
+Status HuffmanCompressor::saveDictionary(const Dictionary& dictionary, const std::string& path) {
+    // Formato HUBD: magic, id (4 bytes) y longitudes de los 256 bytes
+    std::vector<uint8_t> contents = {'H', 'U', 'B', 'D'};
+    putLE(contents, dictionary.id, 4);
+    writeCodeLengths(contents, dictionary.lengths.data(), 256);
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return Status::CreateFailed;
+    file.write(reinterpret_cast<const char*>(contents.data()), contents.size());
+    file.close();
+    return file ? Status::Ok : Status::WriteFailed;
+}
+
+Status HuffmanCompressor::loadDictionary(const std::string& path, Dictionary& dictionary) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return Status::OpenFailed;
+    std::vector<uint8_t> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    // El id debe coincidir con las longitudes y todos los bytes deben tener codigo
+    if (contents.size() < 8 || std::string(contents.begin(), contents.begin() + 4) != "HUBD") {
+        return Status::InvalidFormat;
+    }
+    const uint8_t* ptr = contents.data() + 4;
+    const uint8_t* end = contents.data() + contents.size();
+    Dictionary loaded;
+    loaded.id = static_cast<uint32_t>(readLE(ptr, 4));
+    if (!readCodeLengths(ptr, end, loaded.lengths.data(), 256) || ptr != end ||
+        std::find(loaded.lengths.begin(), loaded.lengths.end(), 0) != loaded.lengths.end() ||
+        loaded.id != dictionaryId(loaded.lengths) ||
+        !buildCanonicalDecodeTable(loaded.lengths.data(), 256, loaded.table)) {
+        return Status::CorruptHeader;
     }
+    assignCanonicalCodes(loaded.lengths.data(), 256, loaded.codes.data());
+    dictionary = std::move(loaded);
+    return Status::Ok;
+}
 
-    uint64_t originalSize = data.size();
-    std::cout << "Tamanio original: " << originalSize << " bytes\n";
+// Compresion de bloques en paralelo: el hilo llamador lee, los hilos de
+// trabajo codifican y el escritor escribe en el orden original, sin que
+// una lectura o escritura lenta detenga a los demas mientras haya lugar.
+// Se mantienen a lo sumo 2 bloques por hilo en vuelo, mas el que se lee y
+// el que se escribe (memoria acotada). Un unico bloque se codifica en el
+// hilo llamador, sin hilos (entradas chicas), repartiendo el conteo de
+// frecuencias entre los hilos.
+struct HuffmanCompressor::BlockPipeline {
+    BlockPipeline(const CompressOptions& options, WriteFn write, bool writerThread)
+        : options(options), write(std::move(write)),
+          blockSize(std::clamp<size_t>(options.blockSize, MIN_BLOCK_SIZE, MAX_BLOCK_SIZE)),
+          threads(ThreadPool::resolve(options.threads)),
+          jobs(threads, 2 * threads + 2, writerThread,
+               [this](BlockJob& job, bool alone) { encode(job, alone ? threads : 1); },
+               [this](BlockJob& job) { return commit(job); }) {
+        report.stats.hardwareCounters = options.hardwareCounters;
+        readStats.hardwareCounters = options.hardwareCounters;
 
-    // Construir tabla de frecuencias
-    std::array<uint64_t, 256> freq{};
-    for (uint8_t b : data) {
-        freq[b]++;
+        // Los puntos de control se guardan con el indice
+        size_t& interval = this->options.checkpointInterval;
+        interval = this->options.writeIndex && interval > 0
+                       ? std::clamp(interval, MIN_CHECKPOINT_INTERVAL, blockSize) : 0;
     }
 
-    // Construir árbol de Huffman
-    std::priority_queue<std::unique_ptr<Node>, std::vector<std::unique_ptr<Node>>, NodeComparator> pq;
-    int symbolCount = 0;
+    // Bloque vacio para llenar (reciclado si hay alguno libre)
+    BlockJob* acquire() {
+        BlockJob* job = jobs.acquire();
+        job->size = 0;
+        return job;
+    }
 
-    for (int i = 0; i < 256; ++i) {
-        if (freq[i] > 0) {
-            pq.push(std::make_unique<Node>(freq[i], i));
-            symbolCount++;
+    // Escribe lo pendiente, el fin de bloques y el indice
+    Status finish(CompressReport& result) {
+        jobs.finish();
+        if (!headerWritten) writeHeader();
+
+        // Fin de bloques, CRC de toda la entrada e indice opcional para
+        // descompresion en paralelo: (desplazamiento, bits, tamanio original)
+        // por bloque, cantidad y "HIDX"
+        std::vector<uint8_t> footer;
+        footer.push_back(BLOCK_END);
+        if (options.streamChecksum) putLE(footer, streamChecksum, 4);
+        if (options.checkpointInterval > 0) {
+            // Intervalo, por bloque la cantidad de puntos de control y su
+            // posicion en bits dentro de los datos codificados, tamanio de
+            // la seccion y "HCPT"
+            size_t sectionStart = footer.size();
+            putLE(footer, options.checkpointInterval, 4);
+            for (const std::vector<uint32_t>& points : checkpoints) {
+                putLE(footer, points.size(), 4);
+                for (uint32_t bit : points) putLE(footer, bit, 4);
+            }
+            putLE(footer, footer.size() - sectionStart + 8, 4);
+            footer.insert(footer.end(), {'H', 'C', 'P', 'T'});
+        }
+        if (options.writeIndex) {
+            for (const BlockIndexEntry& entry : index) {
+                putLE(footer, entry.offset, 8);
+                putLE(footer, entry.bits, 8);
+                putLE(footer, entry.rawSize, 4);
+            }
+            putLE(footer, index.size(), 4);
+            footer.insert(footer.end(), {'H', 'I', 'D', 'X'});
         }
+        emit(footer.data(), footer.size());
+
+        report.stats.merge(readStats);
+        result = report;
+        return ok ? Status::Ok : Status::WriteFailed;
     }
 
-    if (symbolCount == 1) {
-        // Caso especial: solo un simbolo unico
-        auto root = std::make_unique<Node>(freq[pq.top()->byte], std::move(const_cast<std::unique_ptr<Node>&>(pq.top())), nullptr);
-        pq = decltype(pq)();
-        pq.push(std::move(root));
+    void emit(const uint8_t* data, size_t size) {
+        PhaseTimer timer(report.stats, report.stats.write);
+        ok = ok && write(data, size);
+        report.compressedSize += size;
+    }
+
+    void writeHeader() {
+        std::vector<uint8_t> header;
+        header.insert(header.end(), {'H', 'U', 'B', '3'}); // Magic
+        uint8_t flags = (options.writeIndex ? FLAG_INDEX : 0) | (options.dictionary ? FLAG_DICTIONARY : 0) |
+                        (options.blockChecksum ? FLAG_BLOCK_CHECKSUM : 0) |
+                        (options.streamChecksum ? FLAG_STREAM_CHECKSUM : 0) |
+                        (options.checkpointInterval > 0 ? FLAG_CHECKPOINTS : 0);
+        header.push_back(flags);
+        putLE(header, blockSize, 4); // Tamanio de bloque
+        if (options.dictionary) putLE(header, options.dictionary->id, 4);
+        emit(header.data(), header.size());
+        headerWritten = true;
+    }
+
+    // En un hilo de trabajo (o en el llamador si es el unico bloque)
+    void encode(BlockJob& job, unsigned countThreads) {
+        job.output.clear();
+        job.stats = EncodeStats{};
+        job.bits = encodeBlock(job.data, job.size, options, job.output, job.checkpoints, job.stats, countThreads);
+
+        // El CRC de cada bloque se calcula en su hilo; el de toda la
+        // entrada se arma combinandolos en orden
+        if (options.blockChecksum || options.streamChecksum) {
+            PhaseTimer timer(job.stats.phases, job.stats.phases.checksum);
+            job.checksum = Crc32c::compute(job.data, job.size);
+            if (options.blockChecksum) putLE(job.output, job.checksum, 4);
+        }
+    }
+
+    // En el escritor, en el orden de lectura
+    bool commit(BlockJob& job) {
+        if (!headerWritten) writeHeader();
+        index.push_back({report.compressedSize, job.bits, static_cast<uint32_t>(job.size)});
+        if (options.checkpointInterval > 0) checkpoints.push_back(job.checkpoints);
+        emit(job.output.data(), job.output.size());
+        report.originalSize += job.size;
+        report.optimalBits += job.stats.optimalBits;
+        report.encodedBits += job.stats.encodedBits;
+        report.longestCode = std::max(report.longestCode, job.stats.longestCode);
+        report.limitedBlocks += job.stats.limitedBlocks;
+        report.storedBlocks += job.stats.storedBlocks;
+        if (options.streamChecksum) {
+            streamChecksum = Crc32c::combine(streamChecksum, job.checksum, job.size);
+        }
+        report.stats.merge(job.stats.phases);
+        return ok;
+    }
+
+    CompressOptions options;
+    WriteFn write;
+    size_t blockSize;
+    unsigned threads;
+    Stats readStats;             // Del lector; el resto del informe es del escritor
+    bool ok = true;
+    bool headerWritten = false;
+    uint32_t streamChecksum = 0;
+    CompressReport report;
+    std::vector<BlockIndexEntry> index;
+    std::vector<std::vector<uint32_t>> checkpoints; // Por bloque, si se piden
+    OrderedPipeline<BlockJob> jobs; // Ultimo: sus hilos terminan antes que lo demas
+};
+
+Status HuffmanCompressor::compressStream(const ReadFn& read, const WriteFn& write,
+                                         const CompressOptions& options, CompressReport& report) {
+    BlockPipeline pipeline(options, write, true);
+    while (!pipeline.jobs.failed()) {
+        // Con la entrada mapeada cada bloque apunta directamente al mapeo
+        BlockJob* job = pipeline.acquire();
+        {
+            PhaseTimer timer(pipeline.readStats, pipeline.readStats.read);
+            job->data = read(pipeline.blockSize, job->input, job->size);
+        }
+
+        // Un error de lectura corta la salida antes del fin de bloques: nunca
+        // queda un archivo valido con solo un prefijo de la entrada
+        if (!job->data) {
+            pipeline.jobs.release(job);
+            return Status::ReadFailed;
+        }
+        if (job->size == 0) {
+            pipeline.jobs.release(job);
+            break;
+        }
+        pipeline.jobs.submit(job);
+    }
+
+    // Una entrada vacia da un flujo valido sin bloques (cabecera, fin,
+    // CRC e indice vacio), igual que Encoder::finish
+    return pipeline.finish(report);
+}
+
+HuffmanCompressor::Encoder::Encoder(const CompressOptions& options) : options_(options) {}
+
+HuffmanCompressor::Encoder::~Encoder() = default;
+
+Status HuffmanCompressor::Encoder::update(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    // Sin hilo escritor: los bloques se agregan a 'out' dentro de update y
+    // finish, nunca despues
+    out_ = &out;
+    if (!pipeline_) {
+        pipeline_ = std::make_unique<BlockPipeline>(options_, [this](const uint8_t* bytes, size_t count) {
+            out_->insert(out_->end(), bytes, bytes + count);
+            return true;
+        }, false);
     }
 
-    while (pq.size() > 1) {
-        auto a = std::move(const_cast<std::unique_ptr<Node>&>(pq.top())); pq.pop();
-        auto b = std::move(const_cast<std::unique_ptr<Node>&>(pq.top())); pq.pop();
-        pq.push(std::make_unique<Node>(a->freq + b->freq, std::move(a), std::move(b)));
+    // Copiar la entrada al bloque en llenado; cada bloque lleno se codifica
+    size_t blockSize = pipeline_->blockSize;
+    while (size > 0) {
+        if (!current_) {
+            current_ = pipeline_->acquire();
+            current_->input.resize(blockSize);
+        }
+        size_t take = std::min(size, blockSize - current_->size);
+        {
+            PhaseTimer timer(pipeline_->readStats, pipeline_->readStats.read);
+            std::copy(data, data + take, current_->input.data() + current_->size);
+        }
+        current_->size += take;
+        data += take;
+        size -= take;
+
+        if (current_->size == blockSize) {
+            current_->data = current_->input.data();
+            pipeline_->jobs.submit(current_);
+            current_ = nullptr;
+        }
     }
+    return Status::Ok;
+}
+
+Status HuffmanCompressor::Encoder::finish(std::vector<uint8_t>& out) {
+    update(nullptr, 0, out);
+    if (current_ && current_->size > 0) {
+        current_->data = current_->input.data();
+        pipeline_->jobs.submit(current_);
+    } else if (current_) {
+        pipeline_->jobs.release(current_);
+    }
+    current_ = nullptr;
 
-    auto root = std::move(const_cast<std::unique_ptr<Node>&>(pq.top()));
+    Status status = pipeline_->finish(report_);
+    pipeline_.reset();
+    return status;
+}
 
-    // Construir códigos
-    std::vector<std::string> codes(256);
-    buildCodes(root.get(), "", codes);
+Status HuffmanCompressor::compress(const std::string& inputPath, const std::string& outputPath,
+                                   const CompressOptions& options, CompressReport* report) {
+    // Abrir archivo de entrada ("-" es la entrada estandar): mapeado en
+    // memoria si es posible
+    Stats opening;
+    opening.hardwareCounters = options.hardwareCounters;
+    InputFile input;
+    bool opened;
+    {
+        PhaseTimer timer(opening, opening.read);
+        opened = input.open(inputPath);
+    }
+    if (!opened) return Status::OpenFailed;
 
-    // Crear archivo de salida
+    // La salida se crea con la primera escritura: si falla la primera
+    // lectura no queda un archivo a medias
     std::string outPath = outputPath.empty() ? (inputPath + ".HUB") : outputPath;
-    std::ofstream output(outPath, std::ios::binary);
-    if (!output) {
-        std::cerr << "Error: No se pudo crear el archivo: " << outPath << "\n";
-        return false;
+    std::ofstream file;
+    std::ostream* output = nullptr;
+    bool created = true;
+    auto write = [&](const uint8_t* data, size_t size) {
+        if (!output) {
+            output = openOutput(outPath, file);
+            created = output != nullptr;
+            if (!output) return false;
+        }
+        output->write(reinterpret_cast<const char*>(data), size);
+        return static_cast<bool>(*output);
+    };
+
+    CompressReport local;
+    CompressReport& result = report ? *report : local;
+    Status status = compressStream(
+        [&input](size_t maxBytes, std::vector<uint8_t>& buffer, size_t& length) {
+            const uint8_t* chunk = input.next(maxBytes, buffer, length);
+            return input.failed() ? nullptr : chunk;
+        },
+        write, options, result);
+    if (!created) return Status::CreateFailed;
+    if (status != Status::Ok) return status;
+
+    result.stats.merge(opening);
+    PhaseTimer timer(result.stats, result.stats.write);
+    output->flush();
+    if (file.is_open()) file.close();
+    return *output ? Status::Ok : Status::WriteFailed;
+}
+
+Status HuffmanCompressor::compress(const uint8_t* data, size_t size, std::vector<uint8_t>& out,
+                                   const CompressOptions& options, CompressReport* report) {
+    out.clear();
+    out.reserve(compressBound(size, options));
+
+    // nullptr desde el origen es un error de lectura: una entrada vacia sin
+    // buffer usa uno propio
+    static const uint8_t none = 0;
+    if (!data) data = &none;
+    size_t position = 0;
+    CompressReport local;
+    return compressStream(
+        [&](size_t maxBytes, std::vector<uint8_t>&, size_t& length) {
+            length = std::min(maxBytes, size - position);
+            position += length;
+            return data + position - length;
+        },
+        [&out](const uint8_t* bytes, size_t count) {
+            out.insert(out.end(), bytes, bytes + count);
+            return true;
+        },
+        options, report ? *report : local);
+}
+
+Status HuffmanCompressor::compress(const uint8_t* data, size_t size, uint8_t* out, size_t capacity,
+                                   size_t& written, const CompressOptions& options, CompressReport* report) {
+    written = 0;
+    static const uint8_t none = 0;
+    if (!data) data = &none;
+    size_t position = 0;
+    CompressReport local;
+    Status status = compressStream(
+        [&](size_t maxBytes, std::vector<uint8_t>&, size_t& length) {
+            length = std::min(maxBytes, size - position);
+            position += length;
+            return data + position - length;
+        },
+        [&](const uint8_t* bytes, size_t count) {
+            if (count > capacity - written) return false;
+            std::copy(bytes, bytes + count, out + written);
+            written += count;
+            return true;
+        },
+        options, report ? *report : local);
+    return status == Status::WriteFailed ? Status::OutputTooSmall : status;
+}
+
+Status HuffmanCompressor::decompress(const std::string& inputPath, const std::string& outputPath,
+                                     const DecompressOptions& options, DecompressReport* report) {
+    // Abrir archivo de entrada ("-" es la entrada estandar): mapeado en
+    // memoria si es posible
+    Stats stats;
+    stats.hardwareCounters = options.hardwareCounters;
+    InputFile input;
+    bool opened;
+    {
+        PhaseTimer timer(stats, stats.read);
+        opened = input.open(inputPath);
     }
+    if (!opened) return Status::OpenFailed;
+    std::string outPath = outputPath.empty() ? (inputPath + ".txt") : outputPath;
+    uint64_t bytesProduced = 0;
 
-    // Escribir cabecera
-    output.write("HUB1", 4); // Magic
-    writeLE(output, originalSize, 8); // Tamanio original
-    writeLE(output, symbolCount, 2); // Numero de simbolos
+    // Tuberias y dispositivos: decodificacion incremental con memoria acotada
+    if (!input.mapped()) {
+        std::ofstream file;
+        std::ostream* output = openOutput(outPath, file);
+        if (!output) return Status::CreateFailed;
 
-    // Escribir tabla de frecuencias
-    for (int i = 0; i < 256; ++i) {
-        if (freq[i] > 0) {
-            output.put(static_cast<char>(i));
-            writeLE(output, freq[i], 8);
+        Status status = decompressStream(input, *output, options.threads, bytesProduced, options.dictionary,
+                                         stats);
+        if (status != Status::Ok) return status;
+        if (report) {
+            report->bytesProduced = bytesProduced;
+            report->stats = stats;
+        }
+        return Status::Ok;
+    }
+
+    size_t size = 0;
+    const uint8_t* data = input.contents(size);
+    Status status = decompressToFile(data, size, outPath, options, bytesProduced, stats);
+    if (status != Status::Ok) return status;
+
+    if (report) {
+        report->bytesProduced = bytesProduced;
+        report->stats = stats;
+    }
+    return Status::Ok;
+}
+
+Status HuffmanCompressor::decompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out,
+                                     const DecompressOptions& options, DecompressReport* report) {
+    out.clear();
+    if (formatVersion(data, size) == 0) return Status::InvalidFormat;
+
+    Stats stats;
+    stats.hardwareCounters = options.hardwareCounters;
+    std::vector<BlockIndexEntry> index;
+    uint64_t totalSize = 0;
+    Status status = readParallelIndex(data, size, options.threads, options.dictionary, index, totalSize);
+    if (status != Status::Ok) return status;
+
+    uint64_t bytesProduced = 0;
+    if (!index.empty()) {
+        out.resize(totalSize);
+        uint8_t* target = out.data();
+        status = decodeIndexedBlocks(data, size, index, ThreadPool::resolve(options.threads), [target]() {
+            return [target](uint64_t offset, const uint8_t* block, size_t length) {
+                std::copy(block, block + length, target + offset);
+                return true;
+            };
+        }, options.dictionary, stats);
+        if (status != Status::Ok) return status;
+        bytesProduced = totalSize;
+    } else {
+        status = decompressSpan(data, size, [&out](const uint8_t* bytes, size_t count) {
+            out.insert(out.end(), bytes, bytes + count);
+            return true;
+        }, options.threads, bytesProduced, options.dictionary, stats);
+        if (status != Status::Ok) return status;
+    }
+
+    if (report) {
+        report->bytesProduced = bytesProduced;
+        report->stats = stats;
+    }
+    return Status::Ok;
+}
+
+Status HuffmanCompressor::decompress(const uint8_t* data, size_t size, uint8_t* out, size_t capacity,
+                                     size_t& written, const DecompressOptions& options, DecompressReport* report) {
+    written = 0;
+    if (formatVersion(data, size) == 0) return Status::InvalidFormat;
+
+    Stats stats;
+    stats.hardwareCounters = options.hardwareCounters;
+    std::vector<BlockIndexEntry> index;
+    uint64_t totalSize = 0;
+    Status status = readParallelIndex(data, size, options.threads, options.dictionary, index, totalSize);
+    if (status != Status::Ok) return status;
+
+    if (!index.empty()) {
+        if (totalSize > capacity) return Status::OutputTooSmall;
+        status = decodeIndexedBlocks(data, size, index, ThreadPool::resolve(options.threads), [out]() {
+            return [out](uint64_t offset, const uint8_t* block, size_t length) {
+                std::copy(block, block + length, out + offset);
+                return true;
+            };
+        }, options.dictionary, stats);
+        if (status != Status::Ok) return status;
+        written = static_cast<size_t>(totalSize);
+    } else {
+        uint64_t bytesProduced = 0;
+        status = decompressSpan(data, size, [&](const uint8_t* bytes, size_t count) {
+            if (count > capacity - written) return false;
+            std::copy(bytes, bytes + count, out + written);
+            written += count;
+            return true;
+        }, options.threads, bytesProduced, options.dictionary, stats);
+        if (status == Status::WriteFailed) return Status::OutputTooSmall;
+        if (status != Status::Ok) return status;
+    }
+
+    if (report) {
+        report->bytesProduced = written;
+        report->stats = stats;
+    }
+    return Status::Ok;
+}
+
+// Archivo HUB completo en memoria (mapeado) hacia un archivo de salida
+Status HuffmanCompressor::decompressToFile(const uint8_t* data, size_t size, const std::string& outPath,
+                                           const DecompressOptions& options, uint64_t& bytesProduced,
+                                           Stats& stats) {
+    if (formatVersion(data, size) == 0) return Status::InvalidFormat;
+
+    // La salida estandar no admite escrituras fuera de orden: se decodifica
+    // en paralelo pero se escribe en orden, sin indice
+    std::vector<BlockIndexEntry> index;
+    uint64_t totalSize = 0;
+    unsigned threads = outPath == "-" ? 1 : options.threads;
+    Status status = readParallelIndex(data, size, threads, options.dictionary, index, totalSize);
+    if (status != Status::Ok) return status;
+
+    if (!index.empty()) {
+        // Con indice de bloques cada hilo escribe sus bloques directamente
+        // en su posicion final, con su propio stream de salida
+        {
+            std::ofstream output(outPath, std::ios::binary);
+            if (!output) return Status::CreateFailed;
         }
+        std::error_code error;
+        std::filesystem::resize_file(outPath, totalSize, error);
+        if (error) return Status::CreateFailed;
+
+        status = decodeIndexedBlocks(data, size, index, ThreadPool::resolve(threads), [&outPath]() {
+            auto out = std::make_shared<std::fstream>(outPath, std::ios::binary | std::ios::in | std::ios::out);
+            return [out](uint64_t offset, const uint8_t* block, size_t length) {
+                out->seekp(static_cast<std::streamoff>(offset));
+                out->write(reinterpret_cast<const char*>(block), length);
+                return static_cast<bool>(*out);
+            };
+        }, options.dictionary, stats);
+        if (status != Status::Ok) return status;
+        bytesProduced = totalSize;
+    } else {
+        std::ofstream file;
+        std::ostream* output = openOutput(outPath, file);
+        if (!output) return Status::CreateFailed;
+
+        status = decompressSpan(data, size, [output](const uint8_t* bytes, size_t count) {
+            output->write(reinterpret_cast<const char*>(bytes), count);
+            return static_cast<bool>(*output);
+        }, options.threads, bytesProduced, options.dictionary, stats);
+        if (status != Status::Ok) return status;
+
+        PhaseTimer timer(stats, stats.write);
+        output->flush();
+        if (file.is_open()) file.close();
+        if (!*output) return Status::WriteFailed;
     }
 
-    // Codificar datos
-    uint8_t buffer = 0;
-    int bits = 0;
-    uint64_t totalBits = 0;
+    return Status::Ok;
+}
+
+HuffmanCompressor::Decoder::Decoder(const DecompressOptions& options) : dictionary_(options.dictionary) {
+    stats_.hardwareCounters = options.hardwareCounters;
+}
+
+Status HuffmanCompressor::Decoder::update(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    if (error_ != Status::Ok) return error_;
+
+    while (size > 0) {
+        // El indice del final no hace falta para decodificar en orden
+        if (stage_ == Stage::Trailer) return Status::Ok;
+        if (stage_ == Stage::Legacy) {
+            legacy_.insert(legacy_.end(), data, data + size);
+            return Status::Ok;
+        }
+
+        // Cada etapa necesita 'needed_' bytes contiguos: se usan directamente
+        // de la entrada si estan completos, si no se juntan en pending_
+        const uint8_t* unit;
+        if (pending_.empty() && size >= needed_) {
+            unit = data;
+            data += needed_;
+            size -= needed_;
+        } else {
+            size_t take = std::min(needed_ - pending_.size(), size);
+            pending_.insert(pending_.end(), data, data + take);
+            data += take;
+            size -= take;
+            if (pending_.size() < needed_) return Status::Ok;
+            unit = pending_.data();
+        }
 
-    for (uint8_t b : data) {
-        const std::string& code = codes[b];
-        for (char bit : code) {
-            buffer <<= 1;
-            if (bit == '1') buffer |= 1;
-            bits++;
-            totalBits++;
+        error_ = consume(unit, out);
+        pending_.clear();
+        if (error_ != Status::Ok) return error_;
+    }
+    return Status::Ok;
+}
 
-            if (bits == 8) {
-                output.put(static_cast<char>(buffer));
-                buffer = 0;
-                bits = 0;
+Status HuffmanCompressor::Decoder::consume(const uint8_t* unit, std::vector<uint8_t>& out) {
+    const uint8_t* ptr = unit;
+    switch (stage_) {
+        case Stage::Magic: {
+            int version = formatVersion(unit, 4);
+            if (version == 0) return Status::InvalidFormat;
+            // Nuevo flujo: se reinician las estadisticas, no la configuracion
+            produced_ = 0;
+            streamChecksum_ = 0;
+            bool counters = stats_.hardwareCounters;
+            stats_ = Stats{};
+            stats_.hardwareCounters = counters;
+            if (version < 3) {
+                legacy_.assign(unit, unit + 4);
+                stage_ = Stage::Legacy;
+            } else {
+                stage_ = Stage::Header;
+                needed_ = 5;
+            }
+            return Status::Ok;
+        }
+        case Stage::Header: {
+            // Flags (el indice no se usa) y tamanio de bloque
+            flags_ = *ptr++;
+            blockSize_ = readLE(ptr, 4);
+            if (blockSize_ > MAX_BLOCK_SIZE) return Status::CorruptHeader;
+            bool dictionary = flags_ & FLAG_DICTIONARY;
+            stage_ = dictionary ? Stage::DictionaryId : Stage::BlockType;
+            needed_ = dictionary ? 4 : 1;
+            return Status::Ok;
+        }
+        case Stage::DictionaryId:
+            if (!dictionary_ || dictionary_->id != readLE(ptr, 4)) return Status::DictionaryMismatch;
+            stage_ = Stage::BlockType;
+            needed_ = 1;
+            return Status::Ok;
+        case Stage::BlockType:
+            blockType_ = *unit;
+            if (blockType_ == BLOCK_END) {
+                bool checksum = flags_ & FLAG_STREAM_CHECKSUM;
+                stage_ = checksum ? Stage::StreamChecksum : Stage::Trailer;
+                needed_ = checksum ? 4 : 1;
+                return Status::Ok;
             }
+            stage_ = Stage::BlockSizes;
+            needed_ = 8;
+            return Status::Ok;
+        case Stage::BlockSizes: {
+            rawSize_ = readLE(ptr, 4);
+            uint64_t payloadSize = readLE(ptr, 4);
+            if (!validBlock(blockType_, rawSize_, payloadSize, blockSize_)) return Status::CorruptData;
+            stage_ = Stage::Payload;
+            needed_ = static_cast<size_t>(payloadSize);
+            return Status::Ok;
         }
+        case Stage::Payload: {
+            // Se decodifica directamente al final de la salida
+            size_t base = out.size();
+            out.resize(base + rawSize_);
+            if (!decodeBlock(blockType_, unit, needed_, out.data() + base, rawSize_, dictionary_, stats_)) {
+                out.resize(base);
+                return Status::CorruptData;
+            }
+            produced_ += rawSize_;
+            if (flags_ & (FLAG_BLOCK_CHECKSUM | FLAG_STREAM_CHECKSUM)) {
+                PhaseTimer timer(stats_, stats_.checksum);
+                blockChecksum_ = Crc32c::compute(out.data() + base, rawSize_);
+                streamChecksum_ = Crc32c::combine(streamChecksum_, blockChecksum_, rawSize_);
+            }
+            bool checksum = flags_ & FLAG_BLOCK_CHECKSUM;
+            stage_ = checksum ? Stage::BlockChecksum : Stage::BlockType;
+            needed_ = checksum ? 4 : 1;
+            return Status::Ok;
+        }
+        case Stage::BlockChecksum:
+            // El bloque ya se entrego: el error corta el flujo
+            if (readLE(ptr, 4) != blockChecksum_) return Status::ChecksumMismatch;
+            stage_ = Stage::BlockType;
+            needed_ = 1;
+            return Status::Ok;
+        case Stage::StreamChecksum:
+            if (readLE(ptr, 4) != streamChecksum_) return Status::ChecksumMismatch;
+            stage_ = Stage::Trailer;
+            return Status::Ok;
+        default:
+            return Status::Ok;
     }
+}
 
-    if (bits > 0) {
-        buffer <<= (8 - bits);
-        output.put(static_cast<char>(buffer));
+Status HuffmanCompressor::Decoder::finish(std::vector<uint8_t>& out) {
+    Status status = error_;
+    if (status == Status::Ok && stage_ == Stage::Legacy) {
+        status = decompressSpan(legacy_.data(), legacy_.size(), [&out](const uint8_t* bytes, size_t count) {
+            out.insert(out.end(), bytes, bytes + count);
+            return true;
+        }, 1, produced_, dictionary_, stats_);
+    } else if (status == Status::Ok && stage_ != Stage::Trailer) {
+        // Flujo cortado antes del fin de bloques
+        status = stage_ == Stage::Magic ? Status::InvalidFormat
+               : stage_ == Stage::Header || stage_ == Stage::DictionaryId ? Status::CorruptHeader
+               : Status::CorruptData;
     }
 
-    // Escribir numero total de bits
-    writeLE(output, totalBits, 8);
-    output.close();
+    // Listo para un nuevo flujo; bytesProduced conserva el total del anterior
+    stage_ = Stage::Magic;
+    needed_ = 4;
+    pending_.clear();
+    legacy_.clear();
+    legacy_.shrink_to_fit();
+    error_ = Status::Ok;
+    return status;
+}
 
-    // Mostrar resultados
-    uint64_t compressedSize = std::filesystem::file_size(outPath);
-    double ratio = (1.0 - static_cast<double>(compressedSize) / originalSize) * 100.0;
-    
-    std::cout << "Compresion completada exitosamente!\n";
-    std::cout << "Archivo comprimido: " << compressedSize << " bytes\n";
-    std::cout << "Ratio de compresion: " << std::fixed << std::setprecision(2) << ratio << "%\n";
-    std::cout << "Guardado como: " << outPath << "\n";
+int HuffmanCompressor::formatVersion(const uint8_t* data, size_t size) {
+    if (size < 4 || data[0] != 'H' || data[1] != 'U' || data[2] != 'B') return 0;
+    return (data[3] >= '1' && data[3] <= '3') ? data[3] - '0' : 0;
+}
 
-    return true;
+std::ostream* HuffmanCompressor::openOutput(const std::string& path, std::ofstream& file) {
+    // "-" es la salida estandar, en modo binario
+    if (path == "-") {
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        return &std::cout;
+    }
+    file.open(path, std::ios::binary);
+    return file ? &file : nullptr;
 }
 
-bool HuffmanCompressor::decompress(const std::string& inputPath, const std::string& outputPath) {
-    std::cout << "\nIniciando descompresion...\n";
+Status HuffmanCompressor::decompressStream(InputFile& input, std::ostream& output, unsigned threads,
+                                           uint64_t& bytesProduced, const Dictionary* dictionary, Stats& stats) {
+    std::vector<uint8_t> header;
+    std::vector<uint8_t> buffer;
+    size_t length = 0;
+    auto append = [&](size_t bytes) {
+        PhaseTimer timer(stats, stats.read);
+        const uint8_t* chunk = input.next(bytes, buffer, length);
+        header.insert(header.end(), chunk, chunk + length);
+        return length == bytes;
+    };
+    auto write = [&output](const uint8_t* bytes, size_t count) {
+        output.write(reinterpret_cast<const char*>(bytes), count);
+        return static_cast<bool>(output);
+    };
 
-    // Abrir archivo de entrada
-    std::ifstream input(inputPath, std::ios::binary);
-    if (!input) {
-        std::cerr << "Error: No se pudo abrir el archivo: " << inputPath << "\n";
-        return false;
+    if (!append(4)) return input.failed() ? Status::ReadFailed : Status::InvalidFormat;
+    int version = formatVersion(header.data(), header.size());
+    if (version == 0) return Status::InvalidFormat;
+
+    Status status;
+    if (version == 3) {
+        // Cabecera completa (flags, tamanio de bloque y diccionario); los
+        // bloques se leen de a uno, sin buscar el indice del final
+        if (append(5) && (header[4] & FLAG_DICTIONARY)) append(4);
+        uint8_t flags = 0;
+        uint64_t blockSize = 0;
+        const uint8_t* blocks = nullptr;
+        status = readHub3Header(header.data(), header.size(), dictionary, flags, blockSize, blocks);
+        if (status != Status::Ok) return status;
+        status = decodeBlocks([&input](size_t maxBytes, std::vector<uint8_t>& chunk, size_t& count) {
+            return input.next(maxBytes, chunk, count);
+        }, write, flags, blockSize, threads, bytesProduced, dictionary, stats);
+    } else {
+        // HUB1/HUB2 no tienen bloques: se cargan completos
+        size_t size = 0;
+        const uint8_t* rest;
+        {
+            PhaseTimer timer(stats, stats.read);
+            rest = input.contents(size);
+            header.insert(header.end(), rest, rest + size);
+        }
+        status = decompressSpan(header.data(), header.size(), write, 1, bytesProduced, dictionary, stats);
     }
+    if (input.failed()) return Status::ReadFailed; // Datos cortados por el error, no corruptos
+    if (status != Status::Ok) return status;
 
-    // Verificar magic
-    char magic[4];
-    input.read(magic, 4);
-    if (input.gcount() != 4 || std::string(magic, 4) != "HUB1") {
-        std::cerr << "Error: Formato de archivo invalido.\n";
-        return false;
+    PhaseTimer timer(stats, stats.write);
+    output.flush();
+    return output ? Status::Ok : Status::WriteFailed;
+}
+
+Status HuffmanCompressor::decompressSpan(const uint8_t* data, size_t size, const WriteFn& write, unsigned threads,
+                                         uint64_t& bytesProduced, const Dictionary* dictionary, Stats& stats) {
+    switch (formatVersion(data, size)) {
+        case 3: return decompressHub3(data, size, write, threads, bytesProduced, dictionary, stats);
+        case 2: return decompressHub2(data, size, write, bytesProduced, stats);
+        case 1: return decompressHub1(data, size, write, bytesProduced, stats);
+        default: return Status::InvalidFormat;
     }
+}
 
-    // Leer cabecera
-    uint64_t originalSize = readLE(input, 8);
-    uint64_t symbolCount = readLE(input, 2);
+bool HuffmanCompressor::validBlock(int type, uint64_t rawSize, uint64_t payloadSize, uint64_t blockSize) {
+    return (type == BLOCK_HUFFMAN || type == BLOCK_HUFFMAN_MULTI || type == BLOCK_HUFFMAN_CONTEXT ||
+            type == BLOCK_BWT || type == BLOCK_LZ77 || type == BLOCK_DICTIONARY || type == BLOCK_STORED) &&
+           rawSize > 0 && rawSize <= blockSize && payloadSize > 0;
+}
 
-    if (originalSize == UINT64_MAX || symbolCount == UINT64_MAX) {
-        std::cerr << "Error: Cabecera del archivo corrupta.\n";
-        return false;
+HuffmanCompressor::BlockResult HuffmanCompressor::parseBlock(const uint8_t*& ptr, const uint8_t* end,
+                                                              uint64_t blockSize, uint8_t flags, uint8_t* out,
+                                                              uint64_t& rawSize, uint32_t& checksum,
+                                                              const Dictionary* dictionary, Stats& stats) {
+    if (ptr == end) return BlockResult::Corrupt;
+    int type = *ptr++;
+    if (type == BLOCK_END) return BlockResult::End;
+    if (end - ptr < 8) return BlockResult::Corrupt;
+
+    rawSize = readLE(ptr, 4);
+    uint64_t payloadSize = readLE(ptr, 4);
+    uint64_t trailer = (flags & FLAG_BLOCK_CHECKSUM) ? 4 : 0;
+    if (!validBlock(type, rawSize, payloadSize, blockSize) ||
+        payloadSize + trailer > static_cast<uint64_t>(end - ptr)) {
+        return BlockResult::Corrupt;
     }
 
-    std::cout << "Tamanio original: " << originalSize << " bytes\n";
+    const uint8_t* payload = ptr;
+    ptr += payloadSize + trailer;
+    return decodeChecked(type, payload, payloadSize, flags, out, rawSize, checksum, dictionary, stats);
+}
+
+HuffmanCompressor::BlockResult HuffmanCompressor::decodeChecked(int type, const uint8_t* payload,
+                                                                 uint64_t payloadSize, uint8_t flags, uint8_t* out,
+                                                                 uint64_t rawSize, uint32_t& checksum,
+                                                                 const Dictionary* dictionary, Stats& stats) {
+    if (!decodeBlock(type, payload, payloadSize, out, rawSize, dictionary, stats)) return BlockResult::Corrupt;
 
-    // Leer tabla de frecuencias
-    std::array<uint64_t, 256> freq{};
-    for (uint64_t i = 0; i < symbolCount; ++i) {
-        int byte = input.get();
-        if (byte == EOF) {
-            std::cerr << "Error: Tabla de frecuencias truncada.\n";
+    // CRC de los datos decodificados: se compara con el que sigue al
+    // payload y se devuelve para el de toda la entrada
+    if (flags & (FLAG_BLOCK_CHECKSUM | FLAG_STREAM_CHECKSUM)) {
+        PhaseTimer timer(stats, stats.checksum);
+        checksum = Crc32c::compute(out, rawSize);
+    }
+    const uint8_t* trailer = payload + payloadSize;
+    if ((flags & FLAG_BLOCK_CHECKSUM) && readLE(trailer, 4) != checksum) return BlockResult::BadChecksum;
+    return BlockResult::Ok;
+}
+
+Status HuffmanCompressor::readHub3Header(const uint8_t* data, size_t size, const Dictionary* dictionary,
+                                         uint8_t& flags, uint64_t& blockSize, const uint8_t*& blocks) {
+    // Magic, flags, tamanio de bloque y, si se comprimio con diccionario, su id
+    if (size < 9) return Status::CorruptHeader;
+    flags = data[4];
+    const uint8_t* ptr = data + 5;
+    blockSize = readLE(ptr, 4);
+    if (blockSize > MAX_BLOCK_SIZE) return Status::CorruptHeader;
+    if (data[4] & FLAG_DICTIONARY) {
+        if (size < 13) return Status::CorruptHeader;
+        if (!dictionary || dictionary->id != readLE(ptr, 4)) return Status::DictionaryMismatch;
+    }
+    blocks = ptr;
+    return Status::Ok;
+}
+
+bool HuffmanCompressor::readBlockIndex(const uint8_t* data, size_t size, std::vector<BlockIndexEntry>& index,
+                                       uint64_t& totalSize) {
+    // Cabecera valida y pie del archivo: entradas de 20 bytes, cantidad (4) y "HIDX" (4)
+    const uint8_t* ptr = data + 5;
+    if (size < 17) return false;
+    uint64_t blockSize = readLE(ptr, 4);
+    if (blockSize > MAX_BLOCK_SIZE) return false;
+    if (std::string(reinterpret_cast<const char*>(data + size - 4), 4) != "HIDX") return false;
+
+    ptr = data + size - 8;
+    uint64_t count = readLE(ptr, 4);
+    if (static_cast<uint64_t>(size - 8) < count * 20) return false;
+
+    // Cada bloque despues de la cabecera y del anterior, antes del indice y
+    // con un tamanio original valido: totalSize queda acotado antes de que
+    // se reserve la salida con el
+    uint64_t indexStart = size - 8 - count * 20;
+    ptr = data + indexStart;
+    index.resize(count);
+    totalSize = 0;
+    uint64_t previous = 0;
+    for (BlockIndexEntry& entry : index) {
+        entry.offset = readLE(ptr, 8);
+        entry.bits = readLE(ptr, 8);
+        entry.rawSize = static_cast<uint32_t>(readLE(ptr, 4));
+        if (entry.offset < 9 || entry.offset <= previous || entry.offset >= indexStart) return false;
+        if (entry.rawSize == 0 || entry.rawSize > blockSize) return false;
+        previous = entry.offset;
+        totalSize += entry.rawSize;
+    }
+    return true;
+}
+
+bool HuffmanCompressor::checkpointSectionSize(const uint8_t* data, size_t size, size_t entries,
+                                              uint64_t& sectionSize) {
+    // La seccion termina donde empieza el indice, con su tamanio (4) y "HCPT" (4)
+    size_t indexStart = size - 8 - entries * 20;
+    if (indexStart < 17) return false;
+    const uint8_t* sectionEnd = data + indexStart;
+    if (std::string(reinterpret_cast<const char*>(sectionEnd - 4), 4) != "HCPT") return false;
+    const uint8_t* ptr = sectionEnd - 8;
+    sectionSize = readLE(ptr, 4);
+    return sectionSize >= 12 && sectionSize <= indexStart - 9;
+}
+
+bool HuffmanCompressor::readCheckpoints(const uint8_t* data, size_t size, const std::vector<BlockIndexEntry>& index,
+                                        uint64_t& interval, std::vector<std::vector<uint32_t>>& checkpoints) {
+    uint64_t sectionSize = 0;
+    if (!checkpointSectionSize(data, size, index.size(), sectionSize)) return false;
+    const uint8_t* sectionEnd = data + size - 8 - index.size() * 20;
+    const uint8_t* ptr = sectionEnd - sectionSize;
+    const uint8_t* end = sectionEnd - 8;
+    interval = readLE(ptr, 4);
+    if (interval < MIN_CHECKPOINT_INTERVAL) return false;
+
+    // Un bloque tiene un punto de control por intervalo completo despues
+    // del primero, o ninguno si su tipo no admite empezar en el medio
+    checkpoints.assign(index.size(), {});
+    for (size_t i = 0; i < index.size(); ++i) {
+        if (end - ptr < 4) return false;
+        uint64_t count = readLE(ptr, 4);
+        uint64_t expected = index[i].rawSize > 0 ? (index[i].rawSize - 1) / interval : 0;
+        if ((count != 0 && count != expected) || static_cast<uint64_t>(end - ptr) < count * 4) return false;
+        checkpoints[i].resize(static_cast<size_t>(count));
+        for (uint32_t& bit : checkpoints[i]) bit = static_cast<uint32_t>(readLE(ptr, 4));
+    }
+    return ptr == end;
+}
+
+bool HuffmanCompressor::decodeBlockRange(int type, const uint8_t* payload, size_t payloadSize, size_t rawSize,
+                                         const std::vector<uint32_t>* checkpoints, uint64_t interval,
+                                         size_t from, size_t to, uint8_t* out, std::vector<uint8_t>& scratch,
+                                         const Dictionary* dictionary, Stats& stats) {
+    // Tramo vacio: 'out' puede ser nulo y no hay nada que copiar
+    if (from >= to) return true;
+    if (type == BLOCK_STORED) {
+        if (payloadSize != rawSize) return false;
+        PhaseTimer timer(stats, stats.decode);
+        std::memcpy(out, payload + from, to - from);
+        return true;
+    }
+
+    // Sin puntos de control (u otro tipo de bloque) se decodifica completo
+    bool seekable = checkpoints && (type == BLOCK_HUFFMAN || type == BLOCK_DICTIONARY) &&
+                    checkpoints->size() == (rawSize > 0 ? (rawSize - 1) / interval : 0);
+    if (!seekable) {
+        scratch.resize(rawSize);
+        if (!decodeBlock(type, payload, payloadSize, scratch.data(), rawSize, dictionary, stats)) return false;
+        std::memcpy(out, scratch.data() + from, to - from);
+        return true;
+    }
+
+    const uint8_t* ptr = payload;
+    const uint8_t* end = payload + payloadSize;
+    DecodeTable own;
+    const DecodeTable* table = &own;
+    if (type == BLOCK_DICTIONARY) {
+        if (!dictionary) return false;
+        table = &dictionary->table;
+    } else {
+        std::array<uint8_t, 256> lengths{};
+        PhaseTimer timer(stats, stats.codes);
+        if (!readCodeLengths(ptr, end, lengths.data(), 256) || !buildCanonicalDecodeTable(lengths.data(), 256, own)) {
             return false;
         }
-        uint64_t frequency = readLE(input, 8);
-        if (frequency == UINT64_MAX) {
-            std::cerr << "Error: Tabla de frecuencias corrupta.\n";
-            return false;
+    }
+
+    // Desde el punto de control anterior a 'from': ahi empieza un simbolo
+    size_t segment = static_cast<size_t>(from / interval);
+    size_t first = static_cast<size_t>(segment * interval);
+    uint64_t bit = segment > 0 ? (*checkpoints)[segment - 1] : 0;
+    uint64_t available = static_cast<uint64_t>(end - ptr) * 8;
+    if (bit > available) return false;
+
+    PhaseTimer timer(stats, stats.decode);
+    size_t skip = static_cast<size_t>(bit / 8);
+    BitReader reader(ptr + skip, static_cast<size_t>(end - ptr) - skip);
+    reader.refill();
+    reader.consume(static_cast<int>(bit % 8));
+    scratch.resize(to - first);
+    if (!decodeSymbols(reader, *table, scratch.data(), to - first)) return false;
+    std::memcpy(out, scratch.data() + (from - first), to - from);
+    return skip * 8 + reader.bitsConsumed() <= available;
+}
+
+Status HuffmanCompressor::decompressRange(const uint8_t* data, size_t size, uint64_t offset, uint64_t length,
+                                          std::vector<uint8_t>& out, const DecompressOptions& options,
+                                          DecompressReport* report) {
+    out.clear();
+    int version = formatVersion(data, size);
+    if (version == 0) return Status::InvalidFormat;
+
+    Stats stats;
+    stats.hardwareCounters = options.hardwareCounters;
+    auto done = [&]() {
+        if (report) {
+            report->bytesProduced = out.size();
+            report->stats = stats;
         }
-        freq[static_cast<uint8_t>(byte)] = frequency;
+        return Status::Ok;
+    };
+    uint8_t flags = 0;
+    uint64_t blockSize = 0;
+    const uint8_t* blocks = nullptr;
+    if (version == 3) {
+        Status status = readHub3Header(data, size, options.dictionary, flags, blockSize, blocks);
+        if (status != Status::Ok) return status;
     }
+    // Un rango vacio no decodifica ningun bloque
+    if (length == 0) return done();
 
-    // Reconstruir arbol de Huffman
-    std::priority_queue<std::unique_ptr<Node>, std::vector<std::unique_ptr<Node>>, NodeComparator> pq;
+    if (!(flags & FLAG_INDEX)) {
+        // Sin indice: desde el principio, cortando apenas se pasa el rango
+        uint64_t position = 0;
+        uint64_t stop = length > UINT64_MAX - offset ? UINT64_MAX : offset + length;
+        uint64_t bytesProduced = 0;
+        Status status = decompressSpan(data, size, [&](const uint8_t* bytes, size_t count) {
+            uint64_t begin = std::max(position, offset);
+            uint64_t finish = std::min(position + count, stop);
+            if (begin < finish) out.insert(out.end(), bytes + (begin - position), bytes + (finish - position));
+            position += count;
+            return position < stop;
+        }, options.threads, bytesProduced, options.dictionary, stats);
+        if (status != Status::Ok && !(status == Status::WriteFailed && position >= stop)) return status;
+    } else {
+        std::vector<BlockIndexEntry> index;
+        uint64_t totalSize = 0;
+        if (!readBlockIndex(data, size, index, totalSize)) return Status::CorruptIndex;
+        uint64_t interval = 0;
+        std::vector<std::vector<uint32_t>> checkpoints;
+        if ((flags & FLAG_CHECKPOINTS) && !readCheckpoints(data, size, index, interval, checkpoints)) {
+            return Status::CorruptIndex;
+        }
 
-    for (int i = 0; i < 256; ++i) {
-        if (freq[i] > 0) {
-            pq.push(std::make_unique<Node>(freq[i], i));
+        // Rango que empieza en el final o despues: vacio
+        uint64_t stop = offset + std::min(length, totalSize - std::min(offset, totalSize));
+        if (offset >= stop) return done();
+        out.resize(static_cast<size_t>(stop - offset));
+
+        // Solo los bloques que tocan el rango, cada uno desde su posicion
+        std::vector<uint8_t> scratch;
+        uint64_t blockStart = 0;
+        for (size_t i = 0; i < index.size() && blockStart < stop; ++i) {
+            uint64_t blockEnd = blockStart + index[i].rawSize;
+            if (blockEnd > offset) {
+                const uint8_t* ptr = data + index[i].offset;
+                if (size - index[i].offset < 9) return Status::CorruptIndex;
+                int type = *ptr++;
+                uint64_t rawSize = readLE(ptr, 4);
+                uint64_t payloadSize = readLE(ptr, 4);
+                if (!validBlock(type, rawSize, payloadSize, blockSize) || rawSize != index[i].rawSize ||
+                    payloadSize > static_cast<uint64_t>(data + size - ptr)) {
+                    return Status::CorruptData;
+                }
+                size_t from = static_cast<size_t>(std::max(offset, blockStart) - blockStart);
+                size_t to = static_cast<size_t>(std::min(stop, blockEnd) - blockStart);
+                uint8_t* target = out.data() + (blockStart + from - offset);
+                if (!decodeBlockRange(type, ptr, static_cast<size_t>(payloadSize), static_cast<size_t>(rawSize),
+                                      checkpoints.empty() ? nullptr : &checkpoints[i], interval, from, to,
+                                      target, scratch, options.dictionary, stats)) {
+                    return Status::CorruptData;
+                }
+            }
+            blockStart = blockEnd;
         }
     }
+    return done();
+}
 
-    if (pq.empty()) {
-        std::cerr << "Error: No hay simbolos en el archivo.\n";
-        return false;
+Status HuffmanCompressor::decompressRange(const std::string& inputPath, uint64_t offset, uint64_t length,
+                                          const std::string& outputPath, const DecompressOptions& options,
+                                          DecompressReport* report) {
+    // El archivo se mapea sin lectura anticipada: solo se leen las paginas
+    // del pie y de los bloques del rango
+    InputFile input;
+    if (!input.open(inputPath, InputFile::Access::Random)) return Status::OpenFailed;
+    size_t size = 0;
+    const uint8_t* data = input.contents(size);
+    if (input.failed()) return Status::ReadFailed;
+
+    std::vector<uint8_t> range;
+    DecompressReport local;
+    DecompressReport& result = report ? *report : local;
+    Status status = decompressRange(data, size, offset, length, range, options, &result);
+    if (status != Status::Ok) return status;
+
+    std::ofstream file;
+    std::ostream* output = openOutput(outputPath.empty() ? "-" : outputPath, file);
+    if (!output) return Status::CreateFailed;
+    PhaseTimer timer(result.stats, result.stats.write);
+    if (!range.empty()) output->write(reinterpret_cast<const char*>(range.data()), range.size());
+    output->flush();
+    return *output ? Status::Ok : Status::WriteFailed;
+}
+
+Status HuffmanCompressor::readParallelIndex(const uint8_t* data, size_t size, unsigned threads,
+                                            const Dictionary* dictionary, std::vector<BlockIndexEntry>& index,
+                                            uint64_t& totalSize) {
+    // Solo vale la pena con indice, varios hilos y mas de un bloque
+    index.clear();
+    if (formatVersion(data, size) != 3 || size < 5 || !(data[4] & FLAG_INDEX) ||
+        ThreadPool::resolve(threads) < 2) {
+        return Status::Ok;
     }
+    uint8_t flags = 0;
+    uint64_t blockSize = 0;
+    const uint8_t* blocks = nullptr;
+    Status status = readHub3Header(data, size, dictionary, flags, blockSize, blocks);
+    if (status != Status::Ok) return status;
+    if (!readBlockIndex(data, size, index, totalSize)) return Status::CorruptIndex;
+    if (index.size() < 2) index.clear();
+    return Status::Ok;
+}
 
-    if (pq.size() == 1) {
-        // Caso especial: solo un simbolo unico
-        auto root = std::make_unique<Node>(freq[pq.top()->byte], std::move(const_cast<std::unique_ptr<Node>&>(pq.top())), nullptr);
-        pq = decltype(pq)();
-        pq.push(std::move(root));
+template <typename MakeWriter>
+Status HuffmanCompressor::decodeIndexedBlocks(const uint8_t* data, size_t size,
+                                              const std::vector<BlockIndexEntry>& index, unsigned threads,
+                                              MakeWriter makeWriter, const Dictionary* dictionary,
+                                              Stats& stats) {
+    uint8_t flags = data[4];
+    const uint8_t* ptr = data + 5;
+    uint64_t blockSize = readLE(ptr, 4);
+
+    // Posicion de cada bloque en la salida
+    std::vector<uint64_t> outOffsets(index.size());
+    uint64_t total = 0;
+    for (size_t i = 0; i < index.size(); ++i) {
+        outOffsets[i] = total;
+        total += index[i].rawSize;
     }
 
-    while (pq.size() > 1) {
-        auto a = std::move(const_cast<std::unique_ptr<Node>&>(pq.top())); pq.pop();
-        auto b = std::move(const_cast<std::unique_ptr<Node>&>(pq.top())); pq.pop();
-        pq.push(std::make_unique<Node>(a->freq + b->freq, std::move(a), std::move(b)));
+    // Cada hilo toma el siguiente bloque libre; la entrada se comparte y
+    // cada hilo escribe con su propio writer (posicion, datos, tamanio)
+    ThreadPool pool(static_cast<unsigned>(std::min<size_t>(threads, index.size())));
+    std::atomic<size_t> next{0};
+    std::vector<std::future<Status>> workers;
+    std::vector<Stats> workerStats(pool.size());
+    std::vector<uint32_t> checksums(index.size());
+    for (unsigned t = 0; t < pool.size(); ++t) {
+        workerStats[t].hardwareCounters = stats.hardwareCounters;
+        workers.push_back(pool.submit([&, t]() {
+            Stats& local = workerStats[t];
+            auto writer = makeWriter();
+            std::vector<uint8_t> block(blockSize);
+            uint64_t rawSize = 0;
+            for (size_t i = next++; i < index.size(); i = next++) {
+                const uint8_t* blockPtr = data + index[i].offset;
+                BlockResult result = parseBlock(blockPtr, data + size, blockSize, flags, block.data(), rawSize,
+                                                checksums[i], dictionary, local);
+                if (result == BlockResult::BadChecksum) return Status::ChecksumMismatch;
+                if (result != BlockResult::Ok || rawSize != index[i].rawSize) return Status::CorruptData;
+                PhaseTimer timer(local, local.write);
+                if (!writer(outOffsets[i], block.data(), rawSize)) return Status::WriteFailed;
+            }
+            return Status::Ok;
+        }));
+    }
+
+    Status status = Status::Ok;
+    for (std::future<Status>& worker : workers) {
+        Status result = worker.get();
+        if (status == Status::Ok) status = result;
+    }
+    for (const Stats& local : workerStats) {
+        stats.merge(local);
     }
+    if (status != Status::Ok || !(flags & FLAG_STREAM_CHECKSUM)) return status;
 
-    auto root = std::move(const_cast<std::unique_ptr<Node>&>(pq.top()));
+    // El CRC de la entrada va antes del indice y, si la hay, de la seccion
+    // de puntos de control
+    PhaseTimer timer(stats, stats.checksum);
+    uint64_t footerSize = 8 + index.size() * 20;
+    if ((flags & FLAG_CHECKPOINTS)) {
+        uint64_t sectionSize = 0;
+        if (!checkpointSectionSize(data, size, index.size(), sectionSize)) return Status::CorruptIndex;
+        footerSize += sectionSize;
+    }
+    if (size < 9 + footerSize + 4) return Status::CorruptData;
+    uint32_t checksum = 0;
+    for (size_t i = 0; i < index.size(); ++i) {
+        checksum = Crc32c::combine(checksum, checksums[i], index[i].rawSize);
+    }
+    ptr = data + size - footerSize - 4;
+    return readLE(ptr, 4) == checksum ? Status::Ok : Status::ChecksumMismatch;
+}
 
-    // Obtener posicion actual y leer numero total de bits del final
-    std::streampos dataStart = input.tellg();
-    input.seekg(-8, std::ios::end);
-    uint64_t totalBits = readLE(input, 8);
-    input.seekg(dataStart);
+Status HuffmanCompressor::decodeBlocks(const ReadFn& read, const WriteFn& write, uint8_t flags,
+                                       uint64_t blockSize, unsigned threads, uint64_t& bytesProduced,
+                                       const Dictionary* dictionary, Stats& stats) {
+    // El hilo llamador separa los bloques, los hilos de trabajo los
+    // decodifican y verifican, y el escritor los entrega en orden. Un
+    // archivo de un solo bloque se decodifica en el hilo llamador.
+    unsigned workers = ThreadPool::resolve(threads);
+    bool counters = stats.hardwareCounters;
+    Stats writerStats;
+    writerStats.hardwareCounters = counters;
+    uint32_t streamChecksum = 0;
+    Status failure = Status::Ok; // Del primer bloque que no se pudo entregar
+    OrderedPipeline<DecodeJob> jobs(workers, 2 * workers + 2, true,
+        [&](DecodeJob& job, bool) {
+            job.stats = Stats{};
+            job.stats.hardwareCounters = counters;
+            job.output.resize(job.rawSize);
+            job.result = decodeChecked(job.type, job.payload, job.payloadSize, flags, job.output.data(),
+                                       job.rawSize, job.checksum, dictionary, job.stats);
+        },
+        [&](DecodeJob& job) {
+            writerStats.merge(job.stats);
+            if (job.result != BlockResult::Ok) {
+                failure = job.result == BlockResult::BadChecksum ? Status::ChecksumMismatch : Status::CorruptData;
+                return false;
+            }
+            if (flags & FLAG_STREAM_CHECKSUM) {
+                streamChecksum = Crc32c::combine(streamChecksum, job.checksum, job.rawSize);
+            }
+            PhaseTimer timer(writerStats, writerStats.write);
+            if (!write(job.output.data(), job.rawSize)) {
+                failure = Status::WriteFailed;
+                return false;
+            }
+            bytesProduced += job.rawSize;
+            return true;
+        });
 
-    // Crear archivo de salida
-    std::string outPath = outputPath.empty() ? (inputPath + ".txt") : outputPath;
-    std::ofstream output(outPath, std::ios::binary);
-    if (!output) {
-        std::cerr << "Error: No se pudo crear el archivo: " << outPath << "\n";
-        return false;
+    // Exactamente 'bytes' bytes de la entrada, o nullptr si se corta antes
+    size_t length = 0;
+    auto next = [&](size_t bytes, std::vector<uint8_t>& buffer) -> const uint8_t* {
+        PhaseTimer timer(stats, stats.read);
+        const uint8_t* chunk = read(bytes, buffer, length);
+        return length == bytes ? chunk : nullptr;
+    };
+
+    std::vector<uint8_t> scratch;
+    uint64_t trailer = (flags & FLAG_BLOCK_CHECKSUM) ? 4 : 0;
+    Status status = Status::Ok;
+    bool ended = false;
+    while (!jobs.failed()) {
+        const uint8_t* ptr = next(1, scratch);
+        if (!ptr) {
+            status = Status::CorruptData;
+            break;
+        }
+        int type = *ptr;
+        if (type == BLOCK_END) {
+            ended = true;
+            break;
+        }
+
+        // Un payload valido nunca llega al doble del bloque: el limite evita
+        // reservar memoria por un tamanio corrupto al leer de una tuberia
+        ptr = next(8, scratch);
+        uint64_t rawSize = ptr ? readLE(ptr, 4) : 0;
+        uint64_t payloadSize = ptr ? readLE(ptr, 4) : 0;
+        if (!ptr || !validBlock(type, rawSize, payloadSize, blockSize) || payloadSize > 2 * blockSize) {
+            status = Status::CorruptData;
+            break;
+        }
+
+        // El payload y su CRC quedan en el mapeo o se copian al bloque
+        DecodeJob* job = jobs.acquire();
+        job->payload = next(static_cast<size_t>(payloadSize + trailer), job->input);
+        if (!job->payload) {
+            jobs.release(job);
+            status = Status::CorruptData;
+            break;
+        }
+        job->type = type;
+        job->rawSize = rawSize;
+        job->payloadSize = payloadSize;
+        jobs.submit(job);
+    }
+
+    // CRC de toda la entrada despues del fin de bloques
+    uint32_t expected = 0;
+    if (ended && (flags & FLAG_STREAM_CHECKSUM)) {
+        const uint8_t* ptr = next(4, scratch);
+        if (ptr) {
+            expected = static_cast<uint32_t>(readLE(ptr, 4));
+        } else {
+            status = Status::CorruptData;
+        }
+    }
+
+    // Los errores se informan en el orden del archivo
+    bool delivered = jobs.finish();
+    stats.merge(writerStats);
+    if (!delivered) return failure;
+    if (status != Status::Ok) return status;
+    if ((flags & FLAG_STREAM_CHECKSUM) && expected != streamChecksum) return Status::ChecksumMismatch;
+    return Status::Ok;
+}
+
+Status HuffmanCompressor::decompressHub3(const uint8_t* data, size_t size, const WriteFn& write, unsigned threads,
+                                         uint64_t& bytesProduced, const Dictionary* dictionary, Stats& stats) {
+    // Leer cabecera
+    uint8_t flags = 0;
+    uint64_t blockSize = 0;
+    const uint8_t* ptr = nullptr;
+    const uint8_t* end = data + size;
+    Status status = readHub3Header(data, size, dictionary, flags, blockSize, ptr);
+    if (status != Status::Ok) return status;
+
+    // Los payloads se decodifican en su lugar; solo la salida usa buffers
+    return decodeBlocks([&ptr, end](size_t maxBytes, std::vector<uint8_t>&, size_t& length) {
+        length = std::min<size_t>(maxBytes, end - ptr);
+        ptr += length;
+        return ptr - length;
+    }, write, flags, blockSize, threads, bytesProduced, dictionary, stats);
+}
+
+Status HuffmanCompressor::decompressHub2(const uint8_t* data, size_t size, const WriteFn& write,
+                                         uint64_t& bytesProduced, Stats& stats) {
+    // Leer cabecera
+    const uint8_t* ptr = data + 4;
+    const uint8_t* end = data + size;
+    std::array<uint8_t, 256> lengths{};
+    DecodeTable table;
+    if (size < 12) return Status::CorruptHeader;
+    uint64_t originalSize = readLE(ptr, 8);
+    bool valid;
+    {
+        PhaseTimer timer(stats, stats.codes);
+        valid = readCodeLengths(ptr, end, lengths.data(), 256) &&
+                buildCanonicalDecodeTable(lengths.data(), 256, table);
+    }
+    if (!valid) return Status::CorruptHeader;
+
+    // Decodificar datos por tramos
+    BitReader reader(ptr, end - ptr);
+    std::vector<uint8_t> outBuffer(1 << 16);
+
+    while (bytesProduced < originalSize) {
+        size_t chunk = static_cast<size_t>(std::min<uint64_t>(outBuffer.size(), originalSize - bytesProduced));
+        {
+            PhaseTimer timer(stats, stats.decode);
+            valid = decodeSymbols(reader, table, outBuffer.data(), chunk) &&
+                    reader.bitsConsumed() <= static_cast<uint64_t>(end - ptr) * 8;
+        }
+        if (!valid) return Status::CorruptData;
+
+        PhaseTimer timer(stats, stats.write);
+        if (!write(outBuffer.data(), chunk)) return Status::WriteFailed;
+        bytesProduced += chunk;
+    }
+
+    return Status::Ok;
+}
+
+Status HuffmanCompressor::decompressHub1(const uint8_t* data, size_t size, const WriteFn& write,
+                                         uint64_t& bytesProduced, Stats& stats) {
+    // Leer cabecera
+    const uint8_t* ptr = data + 4;
+    const uint8_t* end = data + size;
+    if (end - ptr < 10) return Status::CorruptHeader;
+    uint64_t originalSize = readLE(ptr, 8);
+    uint64_t symbolCount = readLE(ptr, 2);
+
+    // Leer tabla de frecuencias
+    std::array<uint64_t, 256> freq{};
+    if (static_cast<uint64_t>(end - ptr) < symbolCount * 9) return Status::CorruptHeader;
+    for (uint64_t i = 0; i < symbolCount; ++i) {
+        uint8_t byte = *ptr++;
+        freq[byte] = readLE(ptr, 8);
+    }
+
+    // Reconstruir arbol de Huffman
+    Tree tree;
+    bool built;
+    {
+        PhaseTimer timer(stats, stats.tree);
+        built = buildTree(freq, tree);
+    }
+    if (!built) return Status::CorruptHeader;
+
+    // Numero total de bits al final; los datos codificados van antes
+    if (end - ptr < 8) return Status::CorruptData;
+    const uint8_t* trailer = end - 8;
+    uint64_t totalBits = readLE(trailer, 8);
+    size_t payloadSize = static_cast<size_t>(end - 8 - ptr);
+    if (totalBits > static_cast<uint64_t>(payloadSize) * 8) return Status::CorruptData;
+
+    // Tabla de decodificacion: un acceso resuelve simbolo y longitud
+    std::vector<DecodeEntry> table(size_t(1) << DECODE_TABLE_BITS, DecodeEntry{0, 0});
+    {
+        PhaseTimer timer(stats, stats.codes);
+        buildDecodeTable(tree, tree.root, 0, 0, table);
     }
 
     // Decodificar datos
-    const Node* current = root.get();
-    uint64_t bitsRead = 0;
-    uint64_t bytesProduced = 0;
-    int byte;
-
-    while ((byte = input.get()) != EOF && bytesProduced < originalSize) {
-        // Verificar si llegamos a los ultimos 8 bytes (numero total de bits)
-        std::streampos currentPos = input.tellg();
-        input.seekg(0, std::ios::end);
-        std::streampos endPos = input.tellg();
-        input.seekg(currentPos);
-        
-        if (currentPos >= endPos - std::streamoff(8)) break;
-
-        for (int bit = 7; bit >= 0 && bitsRead < totalBits && bytesProduced < originalSize; --bit) {
-            int bitValue = (byte >> bit) & 1;
-            current = bitValue ? current->right.get() : current->left.get();
-            bitsRead++;
-
-            if (current->byte >= 0) {
-                output.put(static_cast<char>(current->byte));
-                bytesProduced++;
-                current = root.get();
+    BitReader reader(ptr, payloadSize);
+    std::vector<uint8_t> outBuffer(1 << 16);
+    size_t outPos = 0;
+    bool corrupt = false;
+
+    // Formato antiguo: las escrituras intermedias se cuentan como decodificacion
+    PhaseTimer timer(stats, stats.decode);
+    while (bytesProduced < originalSize) {
+        reader.refill();
+        const DecodeEntry& entry = table[reader.peek(DECODE_TABLE_BITS)];
+        int symbol;
+
+        if (entry.length > 0) {
+            reader.consume(entry.length);
+            symbol = entry.symbol;
+        } else {
+            // Camino lento: codigo mas largo que la tabla, recorrer el arbol
+            int current = tree.root;
+            while (current >= 256) {
+                if (reader.available() == 0) reader.refill();
+                current = tree.child[current][reader.read(1)];
             }
+            if (current < 0) {
+                corrupt = true;
+                break;
+            }
+            symbol = current;
         }
-    }
 
-    output.close();
-    input.close();
+        if (reader.bitsConsumed() > totalBits) {
+            corrupt = true;
+            break;
+        }
 
-    if (bytesProduced != originalSize) {
-        std::cerr << "Advertencia: Tamanio descomprimido (" << bytesProduced 
-                  << ") no coincide con el esperado (" << originalSize << ").\n";
+        outBuffer[outPos++] = static_cast<uint8_t>(symbol);
+        bytesProduced++;
+        if (outPos == outBuffer.size()) {
+            if (!write(outBuffer.data(), outPos)) return Status::WriteFailed;
+            outPos = 0;
+        }
     }
 
-    std::cout << "Descompresion completada exitosamente!\n";
-    std::cout << "Bytes descomprimidos: " << bytesProduced << "\n";
-    std::cout << "Guardado como: " << outPath << "\n";
+    if (corrupt) return Status::CorruptData;
+    if (!write(outBuffer.data(), outPos)) return Status::WriteFailed;
 
-    return true;
-}
\ No newline at end of file
+    return Status::Ok;
+}
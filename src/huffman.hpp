@@ -4,39 +4,504 @@
 #include <fstream>
 #include <vector>
 #include <string>
-#include <queue>
 #include <array>
 #include <memory>
+#include <functional>
+#include <atomic>
 #include <cstdint>
+#include <utility>
+
+#include "stats.hpp"
+
+class BitReader;
+class BitWriter;
+class InputFile;
+struct Dictionary;
+
+// Opciones de compresion
+struct CompressOptions {
+    int maxCodeLength = 15;       // Longitud maxima de codigo (se ajusta a 1..32)
+    size_t blockSize = 1 << 20;   // Tamanio de bloque (se ajusta a 64 KB..64 MB)
+    unsigned threads = 0;         // Hilos de compresion (0 = todos los nucleos)
+    bool writeIndex = true;       // Indice de bloques al final (descompresion en paralelo)
+    int streams = 1;              // Flujos intercalados por bloque (1, 4 u 8)
+    bool contextModel = false;    // Tablas segun el byte anterior (orden 1) si achican el bloque
+    bool bwt = false;             // Transformacion BWT + move-to-front previa si achica el bloque
+    int lzLevel = 0;              // Coincidencias LZ77 previas si achican el bloque (1..9, 0 = no)
+    size_t lzWindow = size_t(64) << 10; // Ventana de LZ77 (se ajusta a 1 KB..16 MB)
+    const Dictionary* dictionary = nullptr; // Tabla entrenada: sin histograma ni tabla por bloque
+    bool blockChecksum = false;   // CRC32C de cada bloque, verificado al descomprimir
+    bool streamChecksum = false;  // CRC32C de toda la entrada despues del fin de bloques
+    size_t checkpointInterval = 0; // Puntos de control para leer rangos (1 KB..bloque, 0 = no; requiere indice)
+    bool hardwareCounters = false; // Ciclos y fallos de prediccion por fase (Linux)
+};
+
+// Opciones de descompresion
+struct DecompressOptions {
+    unsigned threads = 0;         // Hilos de descompresion (0 = todos los nucleos)
+    bool hardwareCounters = false; // Ciclos y fallos de prediccion por fase (Linux)
+    const Dictionary* dictionary = nullptr; // El usado al comprimir, si se uso uno
+};
+
+// Resultado de compress/decompress
+enum class Status {
+    Ok,
+    OpenFailed,       // No se pudo abrir el archivo de entrada
+    CreateFailed,     // No se pudo crear el archivo de salida
+    WriteFailed,      // Fallo la escritura de la salida
+    ReadFailed,       // Fallo la lectura de la entrada (no es el fin del archivo)
+    InvalidFormat,    // La entrada no es un archivo HUB
+    CorruptHeader,
+    CorruptData,
+    CorruptIndex,
+    OutputTooSmall,   // El buffer de salida del llamador no alcanza
+    DictionaryMismatch, // Falta el diccionario con que se comprimio o es otro
+    ChecksumMismatch, // Los datos descomprimidos no coinciden con su CRC32C
+    DuplicateMember   // Dos archivos distintos quedarian con la misma ruta en un paquete
+};
+
+// Descripcion de un Status para mostrar al usuario
+const char* statusMessage(Status status);
+
+// Resumen de una compresion
+struct CompressReport {
+    uint64_t originalSize = 0;
+    uint64_t compressedSize = 0;
+    uint64_t optimalBits = 0;     // Bits de datos con codigos sin limite de longitud
+    uint64_t encodedBits = 0;     // Bits de datos con los codigos usados
+    int longestCode = 0;          // Codigo mas largo sin limite
+    int limitedBlocks = 0;        // Bloques cuyos codigos se limitaron
+    int storedBlocks = 0;         // Bloques guardados sin comprimir
+    Stats stats;                  // Tiempo por fase
+};
+
+// Resumen de una descompresion
+struct DecompressReport {
+    uint64_t bytesProduced = 0;
+    Stats stats;                  // Tiempo por fase
+};
+
+// Miembro del directorio central de un archivo HUBA
+struct ArchiveEntry {
+    std::string path;             // Ruta relativa, separada con '/'
+    uint64_t size = 0;            // Tamanio original
+    int64_t mtime = 0;            // Ultima modificacion (segundos desde 1970)
+    uint64_t offset = 0;          // Posicion de su flujo HUB3 en el archivo
+    uint64_t compressedSize = 0;  // 0 si el miembro esta vacio
+};
 
 class HuffmanCompressor {
 public:
-    struct Node {
-        uint64_t freq;
-        int byte; // -1 for internal nodes, 0-255 for leaves
-        std::unique_ptr<Node> left;
-        std::unique_ptr<Node> right;
-        
-        Node(uint64_t f, int b) : freq(f), byte(b) {}
-        Node(uint64_t f, std::unique_ptr<Node> l, std::unique_ptr<Node> r) 
-            : freq(f), byte(-1), left(std::move(l)), right(std::move(r)) {}
+    // Codigo empaquetado: los 'length' bits menos significativos de 'bits'
+    struct Code {
+        uint32_t bits;
+        uint8_t length;
+    };
+
+    static constexpr int MAX_CODE_LENGTH = 32;
+
+    // Alfabeto mas grande que admiten las tablas de codigos (bytes mas los
+    // simbolos propios de las transformaciones)
+    static constexpr int MAX_ALPHABET = 320;
+
+    // Entrada de la tabla de decodificacion: simbolo y longitud de su codigo.
+    // length == 0 indica un codigo mas largo que DECODE_TABLE_BITS (camino lento).
+    struct DecodeEntry {
+        uint16_t symbol;
+        uint8_t length;
     };
 
+    static constexpr int DECODE_TABLE_BITS = 11;
+
+    // Tabla de decodificacion canonica: acceso directo para codigos cortos y
+    // primer codigo/desplazamiento por longitud para los largos.
+    struct DecodeTable {
+        std::vector<DecodeEntry> fast;
+        std::array<uint32_t, MAX_CODE_LENGTH + 1> firstCode{};
+        std::array<uint32_t, MAX_CODE_LENGTH + 1> count{};
+        std::array<uint32_t, MAX_CODE_LENGTH + 1> offset{};
+        std::vector<uint16_t> sortedSymbols;
+        int maxLength = 0;
+    };
+
+    static constexpr size_t MIN_BLOCK_SIZE = size_t(64) << 10;
+    static constexpr size_t MAX_BLOCK_SIZE = size_t(64) << 20;
+    static constexpr size_t MIN_CHECKPOINT_INTERVAL = size_t(1) << 10;
+
 private:
-    struct NodeComparator {
-        bool operator()(const std::unique_ptr<Node>& a, const std::unique_ptr<Node>& b) const {
-            return a->freq > b->freq; // Min-heap
-        }
+    // Tipos de bloque del formato HUB3
+    enum BlockType : uint8_t {
+        BLOCK_END = 0,
+        BLOCK_HUFFMAN = 1,
+        BLOCK_HUFFMAN_MULTI = 2,
+        BLOCK_HUFFMAN_CONTEXT = 3,
+        BLOCK_BWT = 4,
+        BLOCK_LZ77 = 5,
+        BLOCK_DICTIONARY = 6,
+        BLOCK_STORED = 7
+    };
+
+    // Con solo el codigo de orden 0, un bloque cuya entropia supera
+    // INCOMPRESSIBLE_ENTROPY (Huffman ahorraria menos de 1/128) se guarda
+    // tal cual. Desde SAMPLE_MIN_BLOCK se estima primero con una muestra
+    // para no contar el histograma completo de datos ya comprimidos.
+    static constexpr size_t SAMPLE_MIN_BLOCK = size_t(128) << 10;
+    static constexpr double INCOMPRESSIBLE_ENTROPY = 8.0 - 8.0 / 128;
+
+    // Flags de la cabecera HUB3. Con FLAG_DICTIONARY la cabecera sigue con
+    // el id del diccionario (4 bytes); con FLAG_BLOCK_CHECKSUM cada bloque
+    // termina con el CRC32C de sus datos originales y con
+    // FLAG_STREAM_CHECKSUM el fin de bloques va seguido del de toda la entrada.
+    // FLAG_CHECKPOINTS (solo con indice) agrega antes del indice la posicion
+    // en bits de cada punto de control de los bloques.
+    static constexpr uint8_t FLAG_INDEX = 0x01;
+    static constexpr uint8_t FLAG_DICTIONARY = 0x02;
+    static constexpr uint8_t FLAG_BLOCK_CHECKSUM = 0x04;
+    static constexpr uint8_t FLAG_STREAM_CHECKSUM = 0x08;
+    static constexpr uint8_t FLAG_CHECKPOINTS = 0x10;
+
+    // Entrada del indice de bloques
+    struct BlockIndexEntry {
+        uint64_t offset;  // Posicion del bloque en el archivo comprimido
+        uint64_t bits;    // Longitud en bits de los datos codificados
+        uint32_t rawSize; // Tamanio original del bloque
+    };
+
+    enum class BlockResult { Ok, End, Corrupt, BadChecksum };
+
+    // Modelo de orden 1: el byte anterior elige una de hasta CONTEXT_TABLES
+    // tablas de codigos (16 tablas de decodificacion caben en la cache L2)
+    static constexpr int CONTEXT_TABLES = 16;
+    static constexpr int CONTEXT_TABLE_BITS = 9;
+    struct ContextModel {
+        int tableCount = 0;
+        std::array<uint8_t, 256> map{}; // Byte anterior -> tabla
+        std::array<std::array<uint8_t, 256>, CONTEXT_TABLES> lengths{};
+    };
+
+    // Acumulado del costo de limitar las longitudes de codigo
+    struct EncodeStats {
+        uint64_t optimalBits = 0;
+        uint64_t encodedBits = 0;
+        int longestCode = 0;
+        int limitedBlocks = 0;
+        int storedBlocks = 0;
+        Stats phases;
+    };
+
+    // Bloque en vuelo durante la compresion en paralelo
+    struct BlockJob {
+        std::vector<uint8_t> input; // Copia del bloque si la entrada no esta mapeada
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        std::vector<uint8_t> output;
+        EncodeStats stats;
+        uint32_t checksum = 0;      // CRC32C de los datos del bloque
+        uint64_t bits = 0;          // Bits del payload, para el indice
+        std::vector<uint32_t> checkpoints; // Posicion en bits de cada punto de control
+        std::atomic<bool> ready{false};
+    };
+
+    // Bloque en vuelo durante la descompresion en paralelo. El payload
+    // (seguido del CRC del bloque, si lo hay) apunta a la entrada mapeada
+    // o a la copia en 'input'.
+    struct DecodeJob {
+        std::vector<uint8_t> input;
+        const uint8_t* payload = nullptr;
+        int type = 0;
+        uint64_t rawSize = 0;
+        uint64_t payloadSize = 0;
+        std::vector<uint8_t> output;
+        uint32_t checksum = 0;      // CRC32C de los datos decodificados
+        BlockResult result = BlockResult::Ok;
+        Stats stats;
+        std::atomic<bool> ready{false};
+    };
+
+    // Origen de los bloques (misma forma que InputFile::next: maxBytes
+    // salvo al final; nullptr si fallo la lectura) y destino de los bytes
+    // producidos
+    using ReadFn = std::function<const uint8_t*(size_t maxBytes, std::vector<uint8_t>& buffer, size_t& length)>;
+    using WriteFn = std::function<bool(const uint8_t* data, size_t size)>;
+
+    // Compresion de bloques en paralelo con escritura en orden (huffman.cpp)
+    struct BlockPipeline;
+
+    // Miembro en vuelo al crear un archivo HUBA (archive.cpp)
+    struct MemberJob;
+
+    // Arbol de Huffman en arreglos fijos, solo para leer HUB1 (cuyos codigos
+    // dependen de la forma exacta del arbol): las hojas son los nodos 0..255
+    // y los internos 256..510; -1 indica un hijo ausente
+    static constexpr int TREE_NODES = 512;
+    struct Tree {
+        std::array<std::array<int16_t, 2>, TREE_NODES> child;
+        int root = -1;
     };
 
 public:
-    // Main functions
-    static bool compress(const std::string& inputPath, const std::string& outputPath = "");
-    static bool decompress(const std::string& inputPath, const std::string& outputPath = "");
+    // Archivo a archivo. Sin outputPath se agrega ".HUB" (o ".txt") a la entrada.
+    static Status compress(const std::string& inputPath, const std::string& outputPath = "",
+                           const CompressOptions& options = CompressOptions{},
+                           CompressReport* report = nullptr);
+    static Status decompress(const std::string& inputPath, const std::string& outputPath = "",
+                             const DecompressOptions& options = DecompressOptions{},
+                             DecompressReport* report = nullptr);
+
+    // Memoria a memoria. Las variantes con vector reemplazan su contenido;
+    // las de buffer fijo escriben a lo sumo 'capacity' bytes e informan en
+    // 'written' cuantos usaron.
+    static Status compress(const uint8_t* data, size_t size, std::vector<uint8_t>& out,
+                           const CompressOptions& options = CompressOptions{},
+                           CompressReport* report = nullptr);
+    static Status compress(const uint8_t* data, size_t size, uint8_t* out, size_t capacity, size_t& written,
+                           const CompressOptions& options = CompressOptions{},
+                           CompressReport* report = nullptr);
+    static Status decompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out,
+                             const DecompressOptions& options = DecompressOptions{},
+                             DecompressReport* report = nullptr);
+    static Status decompress(const uint8_t* data, size_t size, uint8_t* out, size_t capacity, size_t& written,
+                             const DecompressOptions& options = DecompressOptions{},
+                             DecompressReport* report = nullptr);
+
+    // Solo los bytes [offset, offset + length) del original (menos si el
+    // original termina antes). Con indice se decodifican solo los bloques
+    // del rango y, si se comprimio con checkpointInterval, desde el punto de
+    // control anterior al rango; sin indice se decodifica desde el principio
+    // hasta pasar el rango. Los CRC32C no se verifican.
+    static Status decompressRange(const uint8_t* data, size_t size, uint64_t offset, uint64_t length,
+                                  std::vector<uint8_t>& out,
+                                  const DecompressOptions& options = DecompressOptions{},
+                                  DecompressReport* report = nullptr);
+    static Status decompressRange(const std::string& inputPath, uint64_t offset, uint64_t length,
+                                  const std::string& outputPath,
+                                  const DecompressOptions& options = DecompressOptions{},
+                                  DecompressReport* report = nullptr);
+
+    // Tamanio maximo que puede ocupar la compresion de 'size' bytes
+    static size_t compressBound(size_t size, const CompressOptions& options = CompressOptions{});
+
+    // Diccionarios: una tabla de codigos entrenada con un corpus de ejemplo
+    // que comparten compresor y descompresor, para mensajes chicos y
+    // parecidos entre si. Todos los bytes tienen codigo aunque no aparezcan
+    // en el corpus. Las variantes con archivos leen varias muestras.
+    static void trainDictionary(const uint8_t* data, size_t size, Dictionary& dictionary,
+                                int maxCodeLength = 15);
+    static Status trainDictionary(const std::vector<std::string>& samplePaths, Dictionary& dictionary,
+                                  int maxCodeLength = 15);
+    static Status saveDictionary(const Dictionary& dictionary, const std::string& path);
+    static Status loadDictionary(const std::string& path, Dictionary& dictionary);
+
+    // Archivos HUBA: muchos archivos en un contenedor con un directorio
+    // central al final. Cada miembro es un flujo HUB3 independiente, por lo
+    // que se extrae sin decodificar los demas. Las rutas pueden ser archivos
+    // o directorios (se recorren completos); los miembros quedan ordenados
+    // por ruta. Una misma ruta nombrada dos veces se guarda una vez; si dos
+    // archivos distintos dan la misma ruta (por ejemplo "../a/x" y "../b/x",
+    // que se guardan como "x") se devuelve DuplicateMember y, en
+    // 'duplicate', sus rutas en el disco.
+    static Status createArchive(const std::vector<std::string>& inputPaths, const std::string& archivePath,
+                                const CompressOptions& options = CompressOptions{},
+                                CompressReport* report = nullptr,
+                                std::pair<std::string, std::string>* duplicate = nullptr);
+
+    // Lectura de un archivo HUBA con acceso directo a cada miembro. Los
+    // metodos const se pueden llamar desde varios hilos a la vez.
+    class ArchiveReader {
+    public:
+        ArchiveReader();
+        ~ArchiveReader();
+
+        ArchiveReader(const ArchiveReader&) = delete;
+        ArchiveReader& operator=(const ArchiveReader&) = delete;
+
+        // Lee y valida el directorio central
+        Status open(const std::string& path);
+
+        // Miembros ordenados por ruta
+        const std::vector<ArchiveEntry>& entries() const { return entries_; }
+
+        // Busqueda binaria por ruta; nullptr si no esta
+        const ArchiveEntry* find(const std::string& path) const;
+
+        Status extract(const ArchiveEntry& entry, std::vector<uint8_t>& out,
+                       const DecompressOptions& options = DecompressOptions{}) const;
+
+        // Escribe el miembro en outputPath (creando sus directorios) y le
+        // devuelve su fecha de modificacion
+        Status extract(const ArchiveEntry& entry, const std::string& outputPath,
+                       const DecompressOptions& options = DecompressOptions{},
+                       DecompressReport* report = nullptr) const;
+
+    private:
+        std::unique_ptr<InputFile> file_;
+        const uint8_t* data_ = nullptr;
+        size_t size_ = 0;
+        std::vector<ArchiveEntry> entries_;
+    };
+
+    // Compresion incremental: recibe la entrada en tramos de cualquier tamanio
+    // y agrega a 'out' los bloques HUB3 a medida que se completan. Usa memoria
+    // acotada y nunca retrocede en la salida. Tras finish queda listo para
+    // un nuevo flujo.
+    class Encoder {
+    public:
+        explicit Encoder(const CompressOptions& options = CompressOptions{});
+        ~Encoder();
+
+        Encoder(const Encoder&) = delete;
+        Encoder& operator=(const Encoder&) = delete;
+
+        Status update(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+        Status finish(std::vector<uint8_t>& out);
+
+        // Resumen del ultimo flujo terminado
+        const CompressReport& report() const { return report_; }
+
+    private:
+        CompressOptions options_;
+        std::vector<uint8_t>* out_ = nullptr;
+        BlockJob* current_ = nullptr;    // Bloque en llenado, del pipeline
+        std::unique_ptr<BlockPipeline> pipeline_;
+        CompressReport report_;
+    };
+
+    // Descompresion incremental: recibe el archivo comprimido en tramos de
+    // cualquier tamanio y agrega a 'out' cada bloque apenas esta completo,
+    // sin buscar el indice ni el final. HUB1/HUB2 no tienen bloques: se
+    // acumulan y se decodifican en finish.
+    class Decoder {
+    public:
+        explicit Decoder(const DecompressOptions& options = {});
+
+        Status update(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+
+        // Verifica que el flujo este completo y prepara uno nuevo
+        Status finish(std::vector<uint8_t>& out);
+
+        uint64_t bytesProduced() const { return produced_; }
+
+        // Tiempo por fase del flujo actual (o del ultimo terminado)
+        const Stats& stats() const { return stats_; }
+
+    private:
+        enum class Stage {
+            Magic, Header, DictionaryId, BlockType, BlockSizes, Payload, BlockChecksum, StreamChecksum,
+            Trailer, Legacy
+        };
+
+        Status consume(const uint8_t* unit, std::vector<uint8_t>& out);
+
+        Stage stage_ = Stage::Magic;
+        size_t needed_ = 4;             // Bytes que necesita la etapa actual
+        std::vector<uint8_t> pending_;  // Unidad incompleta entre llamadas
+        std::vector<uint8_t> legacy_;   // Archivo HUB1/HUB2 completo
+        uint64_t blockSize_ = 0;
+        uint8_t flags_ = 0;
+        int blockType_ = 0;
+        uint64_t rawSize_ = 0;
+        uint64_t produced_ = 0;
+        uint32_t blockChecksum_ = 0;    // CRC32C del ultimo bloque decodificado
+        uint32_t streamChecksum_ = 0;   // CRC32C de todo lo decodificado
+        Status error_ = Status::Ok;
+        Stats stats_;
+        const Dictionary* dictionary_ = nullptr;
+    };
 
 private:
     // Helper functions
-    static void buildCodes(const Node* node, const std::string& code, std::vector<std::string>& codes);
-    static void writeLE(std::ostream& out, uint64_t value, size_t bytes);
-    static uint64_t readLE(std::istream& in, size_t bytes);
+    static bool buildTree(const std::array<uint64_t, 256>& freq, Tree& tree);
+    static void buildDecodeTable(const Tree& tree, int node, uint32_t code, int length,
+                                 std::vector<DecodeEntry>& table);
+    static void huffmanCodeLengths(const uint64_t* freq, int count, uint8_t* lengths);
+    static void limitCodeLengths(const uint64_t* freq, int count, int maxLength, uint8_t* lengths);
+    static void assignCanonicalCodes(const uint8_t* lengths, int count, Code* codes);
+    static bool buildCanonicalDecodeTable(const uint8_t* lengths, int count, DecodeTable& table);
+    static int decodeSymbol(BitReader& reader, const DecodeEntry* fast, const DecodeTable& table);
+    static int decodeSlow(BitReader& reader, const DecodeTable& table, int tableBits = DECODE_TABLE_BITS);
+    template <typename Symbol>
+    static bool decodeSymbols(BitReader& reader, const DecodeTable& table, Symbol* out, size_t count);
+    static void writeCodeLengths(std::vector<uint8_t>& out, const uint8_t* lengths, int count);
+    static bool readCodeLengths(const uint8_t*& ptr, const uint8_t* end, uint8_t* lengths, int count);
+    static void computeCodeLengths(const uint64_t* freq, int count, int maxCodeLength,
+                                   uint8_t* lengths, EncodeStats& stats);
+    static size_t codeLengthsSize(const uint8_t* lengths, int count);
+    static size_t buildContextModel(const std::array<uint32_t, 256>* counts, int maxCodeLength,
+                                    ContextModel& model, EncodeStats& stats);
+    static bool decodeContextSymbols(BitReader& reader, const std::vector<DecodeTable>& tables,
+                                     const std::array<uint8_t, 256>& map, uint8_t* out, size_t count);
+    static bool decodeLzSymbols(BitReader& reader, const DecodeTable& literals, const DecodeTable& distances,
+                                uint8_t* out, size_t size);
+    static uint64_t encodeLzPayload(const uint8_t* data, size_t size, const CompressOptions& options,
+                                    std::vector<uint8_t>& out, EncodeStats& stats);
+    static uint64_t encodeBwtPayload(const uint8_t* data, size_t size, int maxCodeLength,
+                                     std::vector<uint8_t>& out, EncodeStats& stats);
+    static uint64_t encodeStored(const uint8_t* data, size_t size, std::vector<uint8_t>& out, EncodeStats& stats);
+    static void encodeSymbols(const uint8_t* data, size_t size, const Code* codes, size_t interval,
+                              BitWriter& writer, std::vector<uint32_t>& checkpoints);
+    static uint64_t encodeBlock(const uint8_t* data, size_t size, const CompressOptions& options,
+                                std::vector<uint8_t>& out, std::vector<uint32_t>& checkpoints,
+                                EncodeStats& stats, unsigned countThreads = 1);
+    template <int N>
+    static bool decodeInterleaved(const uint8_t* const* starts, const size_t* sizes,
+                                  const DecodeTable& table, uint8_t* out, size_t count);
+    static bool decodeBlock(int type, const uint8_t* payload, size_t payloadSize,
+                            uint8_t* out, size_t rawSize, const Dictionary* dictionary, Stats& stats);
+    static Status compressStream(const ReadFn& read, const WriteFn& write, const CompressOptions& options,
+                                 CompressReport& report);
+    static int formatVersion(const uint8_t* data, size_t size);
+    static std::ostream* openOutput(const std::string& path, std::ofstream& file);
+    static Status decompressToFile(const uint8_t* data, size_t size, const std::string& outPath,
+                                   const DecompressOptions& options, uint64_t& bytesProduced, Stats& stats);
+    static Status decompressStream(InputFile& input, std::ostream& output, unsigned threads,
+                                   uint64_t& bytesProduced, const Dictionary* dictionary, Stats& stats);
+    static Status decompressSpan(const uint8_t* data, size_t size, const WriteFn& write, unsigned threads,
+                                 uint64_t& bytesProduced, const Dictionary* dictionary, Stats& stats);
+    static bool validBlock(int type, uint64_t rawSize, uint64_t payloadSize, uint64_t blockSize);
+    static BlockResult decodeChecked(int type, const uint8_t* payload, uint64_t payloadSize, uint8_t flags,
+                                     uint8_t* out, uint64_t rawSize, uint32_t& checksum,
+                                     const Dictionary* dictionary, Stats& stats);
+    static BlockResult parseBlock(const uint8_t*& ptr, const uint8_t* end, uint64_t blockSize, uint8_t flags,
+                                  uint8_t* out, uint64_t& rawSize, uint32_t& checksum,
+                                  const Dictionary* dictionary, Stats& stats);
+    static Status readHub3Header(const uint8_t* data, size_t size, const Dictionary* dictionary,
+                                 uint8_t& flags, uint64_t& blockSize, const uint8_t*& blocks);
+    static bool readBlockIndex(const uint8_t* data, size_t size, std::vector<BlockIndexEntry>& index,
+                               uint64_t& totalSize);
+    static bool checkpointSectionSize(const uint8_t* data, size_t size, size_t entries, uint64_t& sectionSize);
+    static bool readCheckpoints(const uint8_t* data, size_t size, const std::vector<BlockIndexEntry>& index,
+                                uint64_t& interval, std::vector<std::vector<uint32_t>>& checkpoints);
+    static bool decodeBlockRange(int type, const uint8_t* payload, size_t payloadSize, size_t rawSize,
+                                 const std::vector<uint32_t>* checkpoints, uint64_t interval, size_t from,
+                                 size_t to, uint8_t* out, std::vector<uint8_t>& scratch,
+                                 const Dictionary* dictionary, Stats& stats);
+    static Status readParallelIndex(const uint8_t* data, size_t size, unsigned threads, const Dictionary* dictionary,
+                                    std::vector<BlockIndexEntry>& index, uint64_t& totalSize);
+    template <typename MakeWriter>
+    static Status decodeIndexedBlocks(const uint8_t* data, size_t size, const std::vector<BlockIndexEntry>& index,
+                                      unsigned threads, MakeWriter makeWriter, const Dictionary* dictionary,
+                                      Stats& stats);
+    static Status decodeBlocks(const ReadFn& read, const WriteFn& write, uint8_t flags, uint64_t blockSize,
+                               unsigned threads, uint64_t& bytesProduced, const Dictionary* dictionary,
+                               Stats& stats);
+    static Status decompressHub3(const uint8_t* data, size_t size, const WriteFn& write, unsigned threads,
+                                 uint64_t& bytesProduced, const Dictionary* dictionary, Stats& stats);
+    static void buildDictionary(const std::array<uint64_t, 256>& freq, int maxCodeLength, Dictionary& dictionary);
+    static uint32_t dictionaryId(const std::array<uint8_t, 256>& lengths);
+    static Status decompressHub2(const uint8_t* data, size_t size, const WriteFn& write, uint64_t& bytesProduced,
+                                 Stats& stats);
+    static Status decompressHub1(const uint8_t* data, size_t size, const WriteFn& write, uint64_t& bytesProduced,
+                                 Stats& stats);
+    static uint64_t readLE(const uint8_t*& ptr, size_t bytes);
+    static void putLE(std::vector<uint8_t>& out, uint64_t value, size_t bytes);
+};
+
+// Tabla de codigos entrenada (archivo HUBD). Se obtiene con
+// HuffmanCompressor::trainDictionary o loadDictionary, que tambien preparan
+// los codigos y la tabla de decodificacion.
+struct Dictionary {
+    uint32_t id = 0;                     // Identifica la tabla en los archivos comprimidos
+    std::array<uint8_t, 256> lengths{};  // Longitud del codigo de cada byte
+    std::array<HuffmanCompressor::Code, 256> codes{};
+    HuffmanCompressor::DecodeTable table;
 };
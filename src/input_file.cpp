@@ -0,0 +1,164 @@
+#include "input_file.hpp"
+#include <algorithm>
+#include <cerrno>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+InputFile::~InputFile() {
+    close();
+}
+
+#ifdef _WIN32
+
+bool InputFile::open(const std::string& path, Access access) {
+    close();
+    DWORD hint = access == Access::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN
+               : access == Access::Random   ? FILE_FLAG_RANDOM_ACCESS
+                                            : 0;
+    HANDLE file = INVALID_HANDLE_VALUE;
+    if (path == "-") {
+        DuplicateHandle(GetCurrentProcess(), GetStdHandle(STD_INPUT_HANDLE), GetCurrentProcess(), &file,
+                        0, FALSE, DUPLICATE_SAME_ACCESS);
+    } else {
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL | hint, nullptr);
+    }
+    if (file == INVALID_HANDLE_VALUE || file == nullptr) return false;
+    file_ = file;
+
+    LARGE_INTEGER size;
+    if (GetFileType(file) == FILE_TYPE_DISK && GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+        HANDLE view = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (view) {
+            void* mapping = MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0);
+            if (mapping) {
+                view_ = view;
+                mapping_ = static_cast<const uint8_t*>(mapping);
+                size_ = static_cast<size_t>(size.QuadPart);
+            } else {
+                CloseHandle(view);
+            }
+        }
+    }
+    return true;
+}
+
+void InputFile::close() {
+    if (mapping_) UnmapViewOfFile(mapping_);
+    if (view_) CloseHandle(view_);
+    if (file_) CloseHandle(file_);
+    mapping_ = nullptr;
+    view_ = nullptr;
+    file_ = nullptr;
+    size_ = 0;
+    position_ = 0;
+    failed_ = false;
+    loaded_.clear();
+}
+
+size_t InputFile::read(uint8_t* dst, size_t bytes) {
+    size_t total = 0;
+    while (total < bytes) {
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(bytes - total, 1u << 30));
+        DWORD got = 0;
+        if (!ReadFile(file_, dst + total, chunk, &got, nullptr)) {
+            // Una tuberia cerrada del otro lado es el fin de la entrada
+            failed_ = GetLastError() != ERROR_BROKEN_PIPE;
+            break;
+        }
+        if (got == 0) break;
+        total += got;
+    }
+    return total;
+}
+
+#else
+
+bool InputFile::open(const std::string& path, Access access) {
+    close();
+    fd_ = path == "-" ? dup(STDIN_FILENO) : ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) return false;
+
+    struct stat info;
+    if (fstat(fd_, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (mapping != MAP_FAILED) {
+            if (access != Access::Normal) {
+                madvise(mapping, static_cast<size_t>(info.st_size),
+                        access == Access::Sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+            }
+            mapping_ = static_cast<const uint8_t*>(mapping);
+            size_ = static_cast<size_t>(info.st_size);
+        }
+    }
+    return true;
+}
+
+void InputFile::close() {
+    if (mapping_) munmap(const_cast<uint8_t*>(mapping_), size_);
+    if (fd_ >= 0) ::close(fd_);
+    mapping_ = nullptr;
+    fd_ = -1;
+    size_ = 0;
+    position_ = 0;
+    failed_ = false;
+    loaded_.clear();
+}
+
+size_t InputFile::read(uint8_t* dst, size_t bytes) {
+    size_t total = 0;
+    while (total < bytes) {
+        ssize_t got = ::read(fd_, dst + total, bytes - total);
+        if (got < 0 && errno == EINTR) continue; // Interrumpida por una senial: reintentar
+        if (got < 0) {
+            failed_ = true;
+            break;
+        }
+        if (got == 0) break;
+        total += static_cast<size_t>(got);
+    }
+    return total;
+}
+
+#endif
+
+const uint8_t* InputFile::next(size_t maxBytes, std::vector<uint8_t>& buffer, size_t& length) {
+    if (mapping_) {
+        length = std::min(maxBytes, size_ - position_);
+        const uint8_t* chunk = mapping_ + position_;
+        position_ += length;
+        return chunk;
+    }
+
+    buffer.resize(maxBytes);
+    length = failed_ ? 0 : read(buffer.data(), maxBytes);
+    return buffer.data();
+}
+
+const uint8_t* InputFile::contents(size_t& size) {
+    if (mapping_) {
+        size = size_;
+        return mapping_;
+    }
+
+    // Sin mapeo: cargar el resto en buffers grandes
+    size_t total = 0;
+    while (true) {
+        loaded_.resize(total + READ_BUFFER_SIZE);
+        size_t got = read(loaded_.data() + total, READ_BUFFER_SIZE);
+        total += got;
+        if (got < READ_BUFFER_SIZE) break;
+    }
+    loaded_.resize(total);
+    size = total;
+    return loaded_.data();
+}
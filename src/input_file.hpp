@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Archivo de entrada de solo lectura.
+// Los archivos regulares se mapean en memoria y se recorren sin copias;
+// si no se puede mapear (tuberias, dispositivos) se lee con buffers grandes.
+class InputFile {
+public:
+    InputFile() = default;
+    ~InputFile();
+
+    InputFile(const InputFile&) = delete;
+    InputFile& operator=(const InputFile&) = delete;
+
+    // Como se va a recorrer el mapeo, para la lectura anticipada del kernel
+    enum class Access {
+        Sequential, // De principio a fin una vez: lee por adelantado y libera lo recorrido
+        Random,     // Saltos a posiciones sueltas: sin lectura anticipada
+        Normal      // Sin indicacion: tramos largos en cualquier orden
+    };
+
+    // "-" abre la entrada estandar
+    bool open(const std::string& path, Access access = Access::Sequential);
+    void close();
+
+    bool mapped() const { return mapping_ != nullptr; }
+
+    // Indica si ya se recorrio todo el archivo (solo se sabe con mapeo)
+    bool atEnd() const { return mapping_ != nullptr && position_ >= size_; }
+
+    // Fallo una lectura (no el fin del archivo): lo leido hasta ahi es
+    // solo un prefijo de la entrada
+    bool failed() const { return failed_; }
+
+    // Siguiente tramo de hasta maxBytes bytes. Si el archivo esta mapeado
+    // devuelve un puntero al mapeo; si no, lo lee en 'buffer'. length = 0 al
+    // final o despues de un error (ver failed).
+    const uint8_t* next(size_t maxBytes, std::vector<uint8_t>& buffer, size_t& length);
+
+    // Contenido completo como un bloque contiguo: el mapeo, o todo lo que
+    // quede por leer cargado en memoria.
+    const uint8_t* contents(size_t& size);
+
+    // Lectura restante en buffers de este tamanio cuando no hay mapeo
+    static constexpr size_t READ_BUFFER_SIZE = size_t(1) << 20;
+
+private:
+    size_t read(uint8_t* dst, size_t bytes);
+
+    const uint8_t* mapping_ = nullptr;
+    size_t size_ = 0;
+    size_t position_ = 0;
+    bool failed_ = false;
+    std::vector<uint8_t> loaded_;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* view_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
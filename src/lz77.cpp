@@ -0,0 +1,101 @@
+#include "lz77.hpp"
+#include <algorithm>
+#include <cstring>
+
+const Lz77::LevelParams Lz77::LEVELS[9] = {
+    {4, 4, 0, 8},        {8, 4, 0, 16},       {32, 4, 0, 32},
+    {16, 4, 4, 16},      {32, 8, 16, 32},     {128, 8, 16, 128},
+    {256, 8, 32, 128},   {1024, 32, 128, 258}, {4096, 32, 258, 258}
+};
+
+size_t Lz77::matchLength(const uint8_t* a, const uint8_t* b, size_t limit) {
+    // De a 8 bytes hasta la primera palabra distinta
+    size_t length = 0;
+    while (length + 8 <= limit) {
+        uint64_t x, y;
+        std::memcpy(&x, a + length, 8);
+        std::memcpy(&y, b + length, 8);
+        if (x != y) break;
+        length += 8;
+    }
+    while (length < limit && a[length] == b[length]) length++;
+    return length;
+}
+
+void Lz77::parse(const uint8_t* data, size_t size, int level, size_t window,
+                 std::vector<Token>& tokens) {
+    const LevelParams& params = LEVELS[std::clamp(level, 1, 9) - 1];
+    window = std::clamp(window, MIN_WINDOW, MAX_WINDOW);
+    tokens.clear();
+    tokens.reserve(size / 4);
+
+    // head: ultima posicion con cada hash; prev: posicion anterior con el
+    // mismo hash (la cadena se corta al salir de la ventana)
+    std::vector<int32_t> head(size_t(1) << HASH_BITS, -1);
+    std::vector<int32_t> prev(size);
+    size_t inserted = 0;
+    auto insertBefore = [&](size_t end) {
+        for (; inserted < end && inserted + MIN_MATCH <= size; ++inserted) {
+            uint32_t h = hash3(data + inserted);
+            prev[inserted] = head[h];
+            head[h] = static_cast<int32_t>(inserted);
+        }
+    };
+
+    // Con una coincidencia previa de al menos 'good' bytes se revisa solo
+    // un cuarto de la cadena
+    auto findMatch = [&](size_t position, uint32_t previous) {
+        Match best{0, 0};
+        if (position + MIN_MATCH > size) return best;
+        size_t limit = std::min<size_t>(MAX_MATCH, size - position);
+        int32_t candidate = head[hash3(data + position)];
+        int chain = previous >= params.good ? params.chain >> 2 : params.chain;
+        for (; candidate >= 0 && chain > 0; --chain) {
+            size_t distance = position - candidate;
+            if (distance > window) break;
+            if (data[candidate + best.length] == data[position + best.length]) {
+                size_t length = matchLength(data + candidate, data + position, limit);
+                if (length > best.length && length >= MIN_MATCH && (length > MIN_MATCH || distance <= TOO_FAR)) {
+                    best = {static_cast<uint32_t>(length), static_cast<uint32_t>(distance)};
+                    if (length >= params.nice || length == limit) break;
+                }
+            }
+            candidate = prev[candidate];
+        }
+        return best;
+    };
+
+    size_t i = 0;
+    Match match{0, 0};
+    bool pending = false;
+    while (i < size) {
+        if (!pending) {
+            insertBefore(i);
+            match = findMatch(i, 0);
+        }
+        pending = false;
+
+        if (match.length < MIN_MATCH) {
+            tokens.push_back({data[i], 0});
+            i++;
+            continue;
+        }
+
+        // Perezosa: si en la posicion siguiente hay una coincidencia mas
+        // larga, esta posicion va como literal
+        if (match.length < params.lazy && i + 1 < size) {
+            insertBefore(i + 1);
+            Match next = findMatch(i + 1, match.length);
+            if (next.length > match.length) {
+                tokens.push_back({data[i], 0});
+                i++;
+                match = next;
+                pending = true;
+                continue;
+            }
+        }
+
+        tokens.push_back({match.length, match.distance});
+        i += match.length;
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Busqueda de coincidencias LZ77 con cadenas de hash (al estilo deflate).
+// El bloque se convierte en literales y pares (longitud, distancia) que
+// luego se codifican con Huffman: un alfabeto de literales y longitudes
+// (256 bytes + LENGTH_CODES) y otro de distancias.
+class Lz77 {
+public:
+    static constexpr uint32_t MIN_MATCH = 3;
+    static constexpr uint32_t MAX_MATCH = MIN_MATCH + 0xFFFF;
+
+    // Ventana: distancia maxima de una coincidencia
+    static constexpr size_t MIN_WINDOW = size_t(1) << 10;
+    static constexpr size_t MAX_WINDOW = size_t(1) << 24;
+
+    // Longitudes (menos MIN_MATCH) y distancias (menos 1) se escriben como
+    // un codigo mas bits extra: los valores 0..3 tienen codigo propio y
+    // despues cada potencia de 2 se parte en dos codigos
+    static constexpr int LENGTH_CODES = 32;
+    static constexpr int DISTANCE_CODES = 48;
+    static constexpr int LITERAL_ALPHABET = 256 + LENGTH_CODES;
+
+    // Literal (distance == 0, el byte en length) o coincidencia
+    struct Token {
+        uint32_t length;
+        uint32_t distance;
+    };
+
+    // Reemplaza tokens con el analisis de data[0..size). level (1..9) fija
+    // cuanto se recorren las cadenas; desde 4 se usa evaluacion perezosa
+    static void parse(const uint8_t* data, size_t size, int level, size_t window,
+                      std::vector<Token>& tokens);
+
+    static int valueCode(uint32_t value) {
+        if (value < 4) return static_cast<int>(value);
+        int bits = 0;
+        while ((value >> bits) > 1) bits++;
+        return 2 * bits + static_cast<int>((value >> (bits - 1)) & 1);
+    }
+
+    static int extraBits(int code) { return code < 4 ? 0 : code / 2 - 1; }
+
+    static uint32_t baseValue(int code) {
+        return code < 4 ? static_cast<uint32_t>(code) : (2u | (code & 1)) << (code / 2 - 1);
+    }
+
+private:
+    // Parametros de cada nivel (los de zlib): candidatos revisados por
+    // posicion, longitud a partir de la cual se revisa un cuarto, longitud
+    // hasta la que se prueba la posicion siguiente (0 = sin evaluacion
+    // perezosa) y longitud que se acepta sin seguir buscando
+    struct LevelParams {
+        int chain;
+        uint32_t good;
+        uint32_t lazy;
+        uint32_t nice;
+    };
+    static const LevelParams LEVELS[9];
+
+    static constexpr int HASH_BITS = 16;
+
+    // Coincidencias de MIN_MATCH bytes mas lejos que esto cuestan mas que los literales
+    static constexpr size_t TOO_FAR = 4096;
+
+    struct Match {
+        uint32_t length;
+        uint32_t distance;
+    };
+
+    static uint32_t hash3(const uint8_t* p) {
+        uint32_t value = p[0] | (p[1] << 8) | (p[2] << 16);
+        return (value * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    static size_t matchLength(const uint8_t* a, const uint8_t* b, size_t limit);
+};
@@ -1,6 +1,14 @@
 #include "huffman.hpp"
+#include "input_file.hpp"
+#include "thread_pool.hpp"
 #include <iostream>
+#include <iomanip>
+#include <ctime>
+#include <filesystem>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <cstdlib>
 
 void mostrarBanner() {
     std::cout << "\n";
@@ -19,7 +27,60 @@ void mostrarMenu() {
     std::cout << "4. Salir\n\n";
 }
 
-void menuComprimir() {
+void mostrarError(Status estado, const std::string& entrada, const std::string& salida) {
+    std::cerr << "Error: " << statusMessage(estado);
+    if (estado == Status::OpenFailed) std::cerr << ": " << entrada;
+    if (estado == Status::CreateFailed || estado == Status::WriteFailed) std::cerr << ": " << salida;
+    std::cerr << ".\n";
+}
+
+// Texto como cadena JSON (comillas, barras y caracteres de control escapados)
+std::string cadenaJson(const std::string& texto) {
+    std::ostringstream salida;
+    salida << '"';
+    for (char c : texto) {
+        if (c == '"' || c == '\\') {
+            salida << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            salida << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+        } else {
+            salida << c;
+        }
+    }
+    salida << '"';
+    return salida.str();
+}
+
+// Desglose por fase en una linea JSON por archivo (en stderr: stdout puede
+// llevar los datos cuando se usa la salida estandar)
+void mostrarEstadisticas(const std::string& operacion, const std::string& archivo, const Stats& estadisticas) {
+    bool contadores = estadisticas.hardwareCounters && !estadisticas.countersUnavailable;
+    const std::pair<const char*, const PhaseStats*> fases[] = {
+        {"read", &estadisticas.read},         {"histogram", &estadisticas.histogram},
+        {"tree", &estadisticas.tree},         {"codes", &estadisticas.codes},
+        {"transform", &estadisticas.transform}, {"encode", &estadisticas.encode},
+        {"decode", &estadisticas.decode},     {"checksum", &estadisticas.checksum},
+        {"write", &estadisticas.write}
+    };
+
+    std::ostringstream json;
+    json << "{\"operation\":\"" << operacion << "\",\"file\":" << cadenaJson(archivo)
+         << ",\"hardware_counters\":" << (contadores ? "true" : "false") << ",\"phases\":{";
+    bool primera = true;
+    for (const auto& fase : fases) {
+        json << (primera ? "" : ",") << "\"" << fase.first << "\":{\"seconds\":"
+             << std::fixed << std::setprecision(6) << fase.second->seconds;
+        if (contadores) {
+            json << ",\"cycles\":" << fase.second->cycles << ",\"branch_misses\":" << fase.second->branchMisses;
+        }
+        json << "}";
+        primera = false;
+    }
+    json << "}}\n";
+    std::cerr << json.str();
+}
+
+void menuComprimir(const CompressOptions& opciones, bool estadisticas) {
     std::cout << "\n=== COMPRIMIR ARCHIVO ===\n";
     std::cout << "Ingrese la ruta del archivo a comprimir: ";
     
@@ -54,14 +115,41 @@ void menuComprimir() {
         }
     }
 
-    if (HuffmanCompressor::compress(ruta, nombreSalida)) {
-        std::cout << "\nCompresion exitosa!\n";
-    } else {
+    if (nombreSalida.empty()) nombreSalida = ruta + ".HUB";
+
+    std::cout << "\nIniciando compresion...\n";
+    CompressReport reporte;
+    Status estado = HuffmanCompressor::compress(ruta, nombreSalida, opciones, &reporte);
+    if (estado != Status::Ok) {
+        mostrarError(estado, ruta, nombreSalida);
         std::cout << "\nError durante la compresion.\n";
+        return;
     }
+
+    // Mostrar resultados
+    double ratio = reporte.originalSize > 0
+                       ? (1.0 - static_cast<double>(reporte.compressedSize) / reporte.originalSize) * 100.0
+                       : 0.0;
+
+    std::cout << "Tamanio original: " << reporte.originalSize << " bytes\n";
+    if (reporte.limitedBlocks > 0) {
+        double costo = (static_cast<double>(reporte.encodedBits) / reporte.optimalBits - 1.0) * 100.0;
+        std::cout << "Codigos limitados a " << opciones.maxCodeLength << " bits en " << reporte.limitedBlocks
+                  << " bloque(s) (maximo sin limite: " << reporte.longestCode << "), costo en tamanio: +"
+                  << std::fixed << std::setprecision(3) << costo << "%\n";
+    }
+    if (reporte.storedBlocks > 0) {
+        std::cout << reporte.storedBlocks << " bloque(s) incompresible(s) guardado(s) sin comprimir\n";
+    }
+    std::cout << "Compresion completada exitosamente!\n";
+    std::cout << "Archivo comprimido: " << reporte.compressedSize << " bytes\n";
+    std::cout << "Ratio de compresion: " << std::fixed << std::setprecision(2) << ratio << "%\n";
+    std::cout << "Guardado como: " << nombreSalida << "\n";
+    if (estadisticas) mostrarEstadisticas("compress", ruta, reporte.stats);
+    std::cout << "\nCompresion exitosa!\n";
 }
 
-void menuDescomprimir() {
+void menuDescomprimir(const DecompressOptions& opciones, bool estadisticas) {
     std::cout << "\n=== DESCOMPRIMIR ARCHIVO ===\n";
     std::cout << "Ingrese la ruta del archivo .HUB a descomprimir: ";
     
@@ -89,11 +177,22 @@ void menuDescomprimir() {
         std::getline(std::cin, nombreSalida);
     }
 
-    if (HuffmanCompressor::decompress(ruta, nombreSalida)) {
-        std::cout << "\nDescompresion exitosa!\n";
-    } else {
+    if (nombreSalida.empty()) nombreSalida = ruta + ".txt";
+
+    std::cout << "\nIniciando descompresion...\n";
+    DecompressReport reporte;
+    Status estado = HuffmanCompressor::decompress(ruta, nombreSalida, opciones, &reporte);
+    if (estado != Status::Ok) {
+        mostrarError(estado, ruta, nombreSalida);
         std::cout << "\nError durante la descompresion.\n";
+        return;
     }
+
+    std::cout << "Descompresion completada exitosamente!\n";
+    std::cout << "Bytes descomprimidos: " << reporte.bytesProduced << "\n";
+    std::cout << "Guardado como: " << nombreSalida << "\n";
+    if (estadisticas) mostrarEstadisticas("decompress", ruta, reporte.stats);
+    std::cout << "\nDescompresion exitosa!\n";
 }
 
 void mostrarAyuda() {
@@ -114,11 +213,463 @@ void mostrarAyuda() {
     std::cout << "CONSEJOS:\n";
     std::cout << "   - Use comillas si la ruta contiene espacios\n";
     std::cout << "   - Los archivos de texto comprimen mejor\n";
-    std::cout << "   - Archivos ya comprimidos (ZIP, JPG) pueden crecer\n";
-    std::cout << "   - Puede especificar rutas relativas o absolutas\n\n";
+    std::cout << "   - Archivos ya comprimidos (ZIP, JPG) se guardan sin comprimir: no crecen\n";
+    std::cout << "   - Puede especificar rutas relativas o absolutas\n";
+    std::cout << "   - --max-code-length N limita los codigos a N bits (por defecto 15)\n";
+    std::cout << "   - --block-size KB fija el tamanio de bloque (por defecto 1024 KB)\n";
+    std::cout << "   - --streams 4 u 8 codifica cada bloque en flujos intercalados\n";
+    std::cout << "   - --context usa tablas segun el byte anterior cuando achican el bloque\n";
+    std::cout << "   - --bwt aplica BWT y move-to-front antes de Huffman cuando achican el bloque\n";
+    std::cout << "   - --lz N busca cadenas repetidas (LZ77, esfuerzo 1..9) con una ventana de\n";
+    std::cout << "     --window KB (por defecto 64 KB)\n";
+    std::cout << "   - --dict ARCHIVO usa una tabla entrenada (para mensajes chicos); se crea con\n";
+    std::cout << "     huffman_tool e -o tabla.hubd muestras... (con --no-index no se agrega el\n";
+    std::cout << "     indice de bloques, que en mensajes chicos no sirve)\n";
+    std::cout << "   - --checksum agrega el CRC32C de cada bloque y de todo el archivo; se verifica\n";
+    std::cout << "     al descomprimir\n";
+    std::cout << "   - --checkpoints KB guarda puntos de control cada KB kilobytes para leer un rango\n";
+    std::cout << "     sin decodificar todo: huffman_tool r archivo.HUB DESDE LARGO\n";
+    std::cout << "   - --threads N comprime y descomprime con N hilos (por defecto todos)\n";
+    std::cout << "   - --stats=json muestra el tiempo de cada fase en stderr; --counters agrega\n";
+    std::cout << "     ciclos y fallos de prediccion de saltos (Linux, perf_event_open)\n";
+    std::cout << "   - Sin menu: huffman_tool c|d|t [-j N] [-o salida] archivos...\n";
+    std::cout << "   - Muchos archivos en uno: huffman_tool a -o paquete.HUBA archivos/directorios...;\n";
+    std::cout << "     l lo lista y x extrae todo o solo los miembros indicados\n\n";
 }
 
-int main() {
+void mostrarUso() {
+    std::cerr << "Uso: huffman_tool [opciones]                                    (menu interactivo)\n";
+    std::cerr << "     huffman_tool c|d|t [-j N] [-o salida] [opciones] [archivos...]\n";
+    std::cerr << "       c comprime, d descomprime, t verifica; sin archivos (o con -) usa la\n";
+    std::cerr << "       entrada y salida estandar. Con varios archivos, -o es un directorio.\n";
+    std::cerr << "     huffman_tool e [-o tabla.hubd] [--max-code-length N] muestras...\n";
+    std::cerr << "       entrena un diccionario con las muestras (por defecto diccionario.hubd)\n";
+    std::cerr << "     huffman_tool a [-o paquete.HUBA] [opciones] archivos/directorios...\n";
+    std::cerr << "     huffman_tool l paquete.HUBA\n";
+    std::cerr << "     huffman_tool x [-j N] [-o directorio] paquete.HUBA [miembros...]\n";
+    std::cerr << "       crea un archivo con varios miembros, lo lista o extrae sus miembros\n";
+    std::cerr << "     huffman_tool r [-o salida] archivo.HUB DESDE LARGO\n";
+    std::cerr << "       descomprime solo los bytes [DESDE, DESDE + LARGO) (por defecto a stdout)\n";
+    std::cerr << "Opciones: [--threads N] [--max-code-length N] [--block-size KB] [--streams 1|4|8]\n";
+    std::cerr << "          [--context] [--bwt] [--lz 1-9] [--window KB] [--dict ARCHIVO]\n";
+    std::cerr << "          [--no-index] [--checksum] [--checkpoints KB] [--stats=json] [--counters]\n";
+}
+
+// Opciones comunes al menu y al modo por lotes. Avanza i si la opcion lleva valor.
+// El diccionario solo se anota: se carga despues de leer todas las opciones.
+bool leerOpcion(int argc, char* argv[], int& i, CompressOptions& opciones, DecompressOptions& opcionesDescompresion,
+                bool& estadisticas, std::string& rutaDiccionario) {
+    std::string arg = argv[i];
+    if (arg == "--stats=json") {
+        estadisticas = true;
+        return true;
+    }
+    if (arg == "--context") {
+        opciones.contextModel = true;
+        return true;
+    }
+    if (arg == "--bwt") {
+        opciones.bwt = true;
+        return true;
+    }
+    if (arg == "--no-index") {
+        opciones.writeIndex = false;
+        return true;
+    }
+    if (arg == "--checksum") {
+        opciones.blockChecksum = true;
+        opciones.streamChecksum = true;
+        return true;
+    }
+    if (arg == "--counters") {
+        opciones.hardwareCounters = true;
+        opcionesDescompresion.hardwareCounters = true;
+        return true;
+    }
+    if (i + 1 >= argc) return false;
+    if (arg == "--max-code-length") {
+        opciones.maxCodeLength = std::atoi(argv[++i]);
+    } else if (arg == "--threads") {
+        opciones.threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        opcionesDescompresion.threads = opciones.threads;
+    } else if (arg == "--streams") {
+        opciones.streams = std::atoi(argv[++i]);
+    } else if (arg == "--block-size") {
+        opciones.blockSize = static_cast<size_t>(std::atol(argv[++i])) << 10;
+    } else if (arg == "--lz") {
+        opciones.lzLevel = std::atoi(argv[++i]);
+    } else if (arg == "--window") {
+        opciones.lzWindow = static_cast<size_t>(std::atol(argv[++i])) << 10;
+    } else if (arg == "--dict") {
+        rutaDiccionario = argv[++i];
+    } else if (arg == "--checkpoints") {
+        opciones.checkpointInterval = static_cast<size_t>(std::atol(argv[++i])) << 10;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Carga el diccionario de --dict y lo usa para comprimir y descomprimir
+bool cargarDiccionario(const std::string& ruta, Dictionary& diccionario, CompressOptions& opciones,
+                       DecompressOptions& opcionesDescompresion) {
+    Status estado = HuffmanCompressor::loadDictionary(ruta, diccionario);
+    if (estado != Status::Ok) {
+        std::cerr << "Error: " << statusMessage(estado) << ": " << ruta << "\n";
+        return false;
+    }
+    opciones.dictionary = &diccionario;
+    opcionesDescompresion.dictionary = &diccionario;
+    return true;
+}
+
+// Verifica un archivo comprimido decodificandolo por tramos, sin escribir la salida
+Status verificarArchivo(const std::string& ruta, const DecompressOptions& opciones, Stats& estadisticas) {
+    InputFile entrada;
+    if (!entrada.open(ruta)) return Status::OpenFailed;
+
+    HuffmanCompressor::Decoder decodificador(opciones);
+    Stats lectura;
+    lectura.hardwareCounters = opciones.hardwareCounters;
+    std::vector<uint8_t> buffer;
+    std::vector<uint8_t> salida;
+    size_t longitud = 0;
+    Status estado;
+    do {
+        const uint8_t* tramo;
+        {
+            PhaseTimer medicion(lectura, lectura.read);
+            tramo = entrada.next(InputFile::READ_BUFFER_SIZE, buffer, longitud);
+        }
+        salida.clear();
+        estado = longitud > 0 ? decodificador.update(tramo, longitud, salida) : decodificador.finish(salida);
+    } while (longitud > 0 && estado == Status::Ok);
+    if (entrada.failed()) estado = Status::ReadFailed;
+
+    estadisticas = decodificador.stats();
+    estadisticas.merge(lectura);
+    return estado;
+}
+
+// Nombre de salida por defecto: agrega ".HUB" al comprimir y lo quita al descomprimir
+std::string nombrePorDefecto(char comando, const std::string& entrada) {
+    if (entrada == "-") return "-";
+    if (comando == 'c') return entrada + ".HUB";
+    if (entrada.size() > 4 && entrada.substr(entrada.size() - 4) == ".HUB") {
+        return entrada.substr(0, entrada.size() - 4);
+    }
+    return entrada + ".txt";
+}
+
+// Modo por lotes: huffman_tool c|d|t|e [-j N] [-o salida] [opciones] [archivos...]
+// Devuelve 0 si todo salio bien, 1 si fallo algun archivo y 2 si el uso es incorrecto.
+int modoLotes(int argc, char* argv[]) {
+    char comando = argv[1][0];
+    CompressOptions opciones;
+    DecompressOptions opcionesDescompresion;
+    unsigned trabajos = 0;
+    bool hilosFijados = false;
+    bool estadisticas = false;
+    std::string rutaDiccionario;
+    Dictionary diccionario;
+    std::string salida;
+    std::vector<std::string> archivos;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            trabajos = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (arg == "-o" && i + 1 < argc) {
+            salida = argv[++i];
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            if (!leerOpcion(argc, argv, i, opciones, opcionesDescompresion, estadisticas, rutaDiccionario)) {
+                std::cerr << "Opcion desconocida: " << arg << "\n";
+                mostrarUso();
+                return 2;
+            }
+            hilosFijados = hilosFijados || arg == "--threads";
+        } else {
+            archivos.push_back(arg);
+        }
+    }
+    if (archivos.empty()) archivos.push_back("-");
+
+    // Entrenar un diccionario con todas las muestras
+    if (comando == 'e') {
+        std::string destino = salida.empty() ? "diccionario.hubd" : salida;
+        Status estado = HuffmanCompressor::trainDictionary(archivos, diccionario, opciones.maxCodeLength);
+        if (estado == Status::Ok) estado = HuffmanCompressor::saveDictionary(diccionario, destino);
+        if (estado != Status::Ok) {
+            std::cerr << "Error: " << statusMessage(estado) << "\n";
+            return 1;
+        }
+        return 0;
+    }
+    if (!rutaDiccionario.empty() && !cargarDiccionario(rutaDiccionario, diccionario, opciones, opcionesDescompresion)) {
+        return 1;
+    }
+
+    bool varios = archivos.size() > 1;
+    if (varios && !salida.empty() && !std::filesystem::is_directory(salida)) {
+        std::cerr << "Error: con varios archivos, -o debe ser un directorio existente.\n";
+        return 2;
+    }
+
+    // Un solo archivo usa todos los hilos para sus bloques; con varios, cada
+    // archivo usa uno y los archivos se reparten entre los hilos
+    trabajos = ThreadPool::resolve(trabajos);
+    if (!hilosFijados) {
+        opciones.threads = varios ? 1 : trabajos;
+        opcionesDescompresion.threads = opciones.threads;
+    }
+
+    std::mutex mutexSalida;
+    auto procesar = [&](const std::string& entrada) {
+        std::string destino = nombrePorDefecto(comando, entrada);
+        if (!salida.empty()) {
+            destino = varios ? (std::filesystem::path(salida) / std::filesystem::path(destino).filename()).string()
+                             : salida;
+        }
+
+        Status estado;
+        Stats medicion;
+        const char* operacion;
+        if (comando == 'c') {
+            CompressReport reporte;
+            estado = HuffmanCompressor::compress(entrada, destino, opciones, &reporte);
+            medicion = reporte.stats;
+            operacion = "compress";
+        } else if (comando == 'd') {
+            DecompressReport reporte;
+            estado = HuffmanCompressor::decompress(entrada, destino, opcionesDescompresion, &reporte);
+            medicion = reporte.stats;
+            operacion = "decompress";
+        } else {
+            estado = verificarArchivo(entrada, opcionesDescompresion, medicion);
+            operacion = "test";
+        }
+
+        std::lock_guard<std::mutex> lock(mutexSalida);
+        if (estado != Status::Ok) {
+            std::cerr << "Error: " << statusMessage(estado) << ": " << entrada << "\n";
+            return false;
+        }
+        if (estadisticas) mostrarEstadisticas(operacion, entrada, medicion);
+        return true;
+    };
+
+    bool ok = true;
+    if (!varios) {
+        ok = procesar(archivos[0]);
+    } else {
+        ThreadPool pool(static_cast<unsigned>(std::min<size_t>(trabajos, archivos.size())));
+        std::vector<std::future<bool>> resultados;
+        resultados.reserve(archivos.size());
+        for (const std::string& entrada : archivos) {
+            resultados.push_back(pool.submit([&procesar, &entrada]() { return procesar(entrada); }));
+        }
+        for (std::future<bool>& resultado : resultados) {
+            ok = resultado.get() && ok;
+        }
+    }
+    return ok ? 0 : 1;
+}
+
+// Archivos HUBA: huffman_tool a|l|x [-j N] [-o salida] [opciones] [rutas...]
+// Devuelve 0 si todo salio bien, 1 si fallo algo y 2 si el uso es incorrecto.
+int modoArchivo(int argc, char* argv[]) {
+    char comando = argv[1][0];
+    CompressOptions opciones;
+    DecompressOptions opcionesDescompresion;
+    unsigned trabajos = 0;
+    bool estadisticas = false;
+    std::string rutaDiccionario;
+    Dictionary diccionario;
+    std::string salida;
+    std::vector<std::string> rutas;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            trabajos = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (arg == "-o" && i + 1 < argc) {
+            salida = argv[++i];
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            if (!leerOpcion(argc, argv, i, opciones, opcionesDescompresion, estadisticas, rutaDiccionario)) {
+                std::cerr << "Opcion desconocida: " << arg << "\n";
+                mostrarUso();
+                return 2;
+            }
+        } else {
+            rutas.push_back(arg);
+        }
+    }
+    if (rutas.empty()) {
+        mostrarUso();
+        return 2;
+    }
+    if (!rutaDiccionario.empty() && !cargarDiccionario(rutaDiccionario, diccionario, opciones, opcionesDescompresion)) {
+        return 1;
+    }
+
+    if (comando == 'a') {
+        std::string destino = salida.empty() ? "paquete.HUBA" : salida;
+        CompressReport reporte;
+        std::pair<std::string, std::string> repetido;
+        Status estado = HuffmanCompressor::createArchive(rutas, destino, opciones, &reporte, &repetido);
+        if (estado == Status::DuplicateMember) {
+            std::cerr << "Error: " << statusMessage(estado) << ": " << repetido.first << " y " << repetido.second
+                      << "\n";
+            return 1;
+        }
+        if (estado != Status::Ok) {
+            std::cerr << "Error: " << statusMessage(estado) << ": " << destino << "\n";
+            return 1;
+        }
+        if (estadisticas) mostrarEstadisticas("archive", destino, reporte.stats);
+        return 0;
+    }
+
+    HuffmanCompressor::ArchiveReader paquete;
+    Status estado = paquete.open(rutas[0]);
+    if (estado != Status::Ok) {
+        std::cerr << "Error: " << statusMessage(estado) << ": " << rutas[0] << "\n";
+        return 1;
+    }
+
+    if (comando == 'l') {
+        for (const ArchiveEntry& miembro : paquete.entries()) {
+            std::time_t fecha = static_cast<std::time_t>(miembro.mtime);
+            std::cout << std::setw(12) << miembro.size << " " << std::setw(12) << miembro.compressedSize << "  "
+                      << std::put_time(std::localtime(&fecha), "%Y-%m-%d %H:%M") << "  " << miembro.path << "\n";
+        }
+        return 0;
+    }
+
+    // Extraer los miembros pedidos (o todos), repartidos entre los hilos:
+    // cada uno se decodifica sin tocar los demas
+    std::vector<const ArchiveEntry*> elegidos;
+    bool ok = true;
+    if (rutas.size() == 1) {
+        for (const ArchiveEntry& miembro : paquete.entries()) elegidos.push_back(&miembro);
+    }
+    for (size_t i = 1; i < rutas.size(); ++i) {
+        const ArchiveEntry* miembro = paquete.find(rutas[i]);
+        if (!miembro) {
+            std::cerr << "Error: no esta en el archivo: " << rutas[i] << "\n";
+            ok = false;
+            continue;
+        }
+        elegidos.push_back(miembro);
+    }
+
+    trabajos = ThreadPool::resolve(trabajos);
+    opcionesDescompresion.threads = elegidos.size() > 1 ? 1 : trabajos;
+    std::filesystem::path directorio = salida.empty() ? std::filesystem::path(".") : std::filesystem::path(salida);
+    std::mutex mutexSalida;
+    auto extraer = [&](const ArchiveEntry& miembro) {
+        std::string destino = (directorio / std::filesystem::path(miembro.path)).string();
+        DecompressReport reporte;
+        Status resultado = paquete.extract(miembro, destino, opcionesDescompresion, &reporte);
+
+        std::lock_guard<std::mutex> lock(mutexSalida);
+        if (resultado != Status::Ok) {
+            std::cerr << "Error: " << statusMessage(resultado) << ": " << miembro.path << "\n";
+            return false;
+        }
+        if (estadisticas) mostrarEstadisticas("extract", miembro.path, reporte.stats);
+        return true;
+    };
+
+    if (elegidos.size() == 1) {
+        ok = extraer(*elegidos[0]) && ok;
+    } else if (!elegidos.empty()) {
+        ThreadPool pool(static_cast<unsigned>(std::min<size_t>(trabajos, elegidos.size())));
+        std::vector<std::future<bool>> resultados;
+        resultados.reserve(elegidos.size());
+        for (const ArchiveEntry* miembro : elegidos) {
+            resultados.push_back(pool.submit([&extraer, miembro]() { return extraer(*miembro); }));
+        }
+        for (std::future<bool>& resultado : resultados) {
+            ok = resultado.get() && ok;
+        }
+    }
+    return ok ? 0 : 1;
+}
+
+// Rango del original: huffman_tool r [-o salida] [opciones] archivo DESDE LARGO
+// Devuelve 0 si salio bien, 1 si fallo y 2 si el uso es incorrecto.
+int modoRango(int argc, char* argv[]) {
+    CompressOptions opciones;
+    DecompressOptions opcionesDescompresion;
+    bool estadisticas = false;
+    std::string rutaDiccionario;
+    Dictionary diccionario;
+    std::string salida = "-";
+    std::vector<std::string> argumentos;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) {
+            salida = argv[++i];
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            if (!leerOpcion(argc, argv, i, opciones, opcionesDescompresion, estadisticas, rutaDiccionario)) {
+                std::cerr << "Opcion desconocida: " << arg << "\n";
+                mostrarUso();
+                return 2;
+            }
+        } else {
+            argumentos.push_back(arg);
+        }
+    }
+    if (argumentos.size() != 3) {
+        mostrarUso();
+        return 2;
+    }
+    if (!rutaDiccionario.empty() && !cargarDiccionario(rutaDiccionario, diccionario, opciones, opcionesDescompresion)) {
+        return 1;
+    }
+
+    uint64_t desde = std::strtoull(argumentos[1].c_str(), nullptr, 10);
+    uint64_t largo = std::strtoull(argumentos[2].c_str(), nullptr, 10);
+    DecompressReport reporte;
+    Status estado = HuffmanCompressor::decompressRange(argumentos[0], desde, largo, salida, opcionesDescompresion,
+                                                       &reporte);
+    if (estado != Status::Ok) {
+        std::cerr << "Error: " << statusMessage(estado) << ": " << argumentos[0] << "\n";
+        return 1;
+    }
+    if (estadisticas) mostrarEstadisticas("range", argumentos[0], reporte.stats);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    // Modo por lotes si el primer argumento es un comando
+    if (argc > 1) {
+        std::string comando = argv[1];
+        if (comando == "c" || comando == "d" || comando == "t" || comando == "e") return modoLotes(argc, argv);
+        if (comando == "a" || comando == "l" || comando == "x") return modoArchivo(argc, argv);
+        if (comando == "r") return modoRango(argc, argv);
+    }
+
+    CompressOptions opciones;
+    DecompressOptions opcionesDescompresion;
+    bool estadisticas = false;
+    std::string rutaDiccionario;
+    Dictionary diccionario;
+
+    // Opciones de linea de comandos
+    for (int i = 1; i < argc; ++i) {
+        if (!leerOpcion(argc, argv, i, opciones, opcionesDescompresion, estadisticas, rutaDiccionario)) {
+            std::cerr << "Opcion desconocida: " << argv[i] << "\n";
+            mostrarUso();
+            return 1;
+        }
+    }
+    if (!rutaDiccionario.empty() && !cargarDiccionario(rutaDiccionario, diccionario, opciones, opcionesDescompresion)) {
+        return 1;
+    }
+
     std::cout << "Iniciando Huffman Compression Tool...\n";
 
     while (true) {
@@ -130,9 +681,9 @@ int main() {
         std::getline(std::cin, opcion);
         
         if (opcion == "1") {
-            menuComprimir();
+            menuComprimir(opciones, estadisticas);
         } else if (opcion == "2") {
-            menuDescomprimir();
+            menuDescomprimir(opcionesDescompresion, estadisticas);
         } else if (opcion == "3") {
             mostrarAyuda();
         } else if (opcion == "4") {
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "ring_queue.hpp"
+
+// Lector, trabajadores y escritor en orden, unidos por colas sin bloqueos.
+// El hilo que llama lee cada trabajo y lo entrega (submit); los
+// trabajadores lo procesan en cualquier orden y el escritor lo confirma
+// (commit) en el orden de entrega, en su propio hilo o, sin hilo escritor,
+// en el que llama cuando hace falta lugar. Los trabajos se reciclan con
+// sus buffers: nunca hay mas de 'capacity' en vuelo.
+//
+// Los hilos se crean con el segundo trabajo: un unico trabajo se procesa
+// en finish en el hilo que llama (alone = true). Sin trabajadores cada
+// trabajo se procesa y confirma al entregarlo. Job necesita un miembro
+// std::atomic<bool> ready.
+template <typename Job>
+class OrderedPipeline {
+public:
+    using ProcessFn = std::function<void(Job& job, bool alone)>;
+    using CommitFn = std::function<bool(Job& job)>;
+
+    OrderedPipeline(unsigned workers, size_t capacity, bool writerThread, ProcessFn process, CommitFn commit)
+        : workerCount_(workers), capacity_(std::max<size_t>(capacity, 1)), writerThread_(writerThread),
+          process_(std::move(process)), commit_(std::move(commit)),
+          work_(capacity_ + workers), order_(capacity_ + 1), recycled_(capacity_) {}
+
+    ~OrderedPipeline() { stop(); }
+
+    OrderedPipeline(const OrderedPipeline&) = delete;
+    OrderedPipeline& operator=(const OrderedPipeline&) = delete;
+
+    // Trabajo libre para llenar: uno devuelto por el escritor, uno nuevo
+    // si hay lugar o, si no, el primero que se confirme
+    Job* acquire() {
+        while (true) {
+            Job* job = nullptr;
+            if (!free_.empty()) {
+                job = free_.back();
+                free_.pop_back();
+                return job;
+            }
+            if (recycled_.tryPop(job)) return job;
+            if (jobs_.size() < capacity_) {
+                jobs_.push_back(std::make_unique<Job>());
+                return jobs_.back().get();
+            }
+            if (writer_.joinable()) return recycled_.pop();
+            commitNext();
+        }
+    }
+
+    // Devuelve un trabajo que no se lleno
+    void release(Job* job) { free_.push_back(job); }
+
+    void submit(Job* job) {
+        job->ready.store(false, std::memory_order_relaxed);
+        if (workerCount_ == 0) {
+            process_(*job, false);
+            commitJob(*job);
+            free_.push_back(job);
+            return;
+        }
+        if (workers_.empty()) {
+            if (!first_) {
+                first_ = job;
+                return;
+            }
+            start();
+            dispatch(first_);
+            first_ = nullptr;
+        }
+        dispatch(job);
+    }
+
+    // Confirma todo lo entregado y detiene los hilos; false si algun commit fallo
+    bool finish() {
+        if (first_) {
+            process_(*first_, true);
+            commitJob(*first_);
+            free_.push_back(first_);
+            first_ = nullptr;
+        }
+        if (writer_.joinable()) {
+            order_.push(nullptr);
+            writer_.join();
+        } else {
+            while (commitNext()) {}
+        }
+        stop();
+        return !failed();
+    }
+
+    // Algun commit fallo: los trabajos siguientes se descartan sin confirmar
+    bool failed() const { return failed_.load(std::memory_order_acquire); }
+
+private:
+    void start() {
+        for (unsigned i = 0; i < workerCount_; ++i) {
+            workers_.emplace_back([this]() {
+                while (Job* job = work_.pop()) {
+                    process_(*job, false);
+                    job->ready.store(true, std::memory_order_release);
+                    ready_.notify();
+                }
+            });
+        }
+        if (writerThread_) {
+            writer_ = std::thread([this]() {
+                while (Job* job = order_.pop()) {
+                    waitReady(*job);
+                    commitJob(*job);
+                    recycled_.push(job);
+                }
+            });
+        }
+    }
+
+    void dispatch(Job* job) {
+        order_.push(job);
+        work_.push(job);
+    }
+
+    void waitReady(Job& job) {
+        Backoff::until(ready_, [&job]() { return job.ready.load(std::memory_order_acquire); });
+    }
+
+    void commitJob(Job& job) {
+        if (!failed() && !commit_(job)) failed_.store(true, std::memory_order_release);
+    }
+
+    // Sin hilo escritor: confirma el trabajo mas antiguo, si hay
+    bool commitNext() {
+        Job* job = nullptr;
+        if (!order_.tryPop(job)) return false;
+        waitReady(*job);
+        commitJob(*job);
+        free_.push_back(job);
+        return true;
+    }
+
+    void stop() {
+        if (writer_.joinable()) {
+            order_.push(nullptr);
+            writer_.join();
+        }
+        for (size_t i = 0; i < workers_.size(); ++i) work_.push(nullptr);
+        for (std::thread& worker : workers_) worker.join();
+        workers_.clear();
+    }
+
+    unsigned workerCount_;
+    size_t capacity_;
+    bool writerThread_;
+    ProcessFn process_;
+    CommitFn commit_;
+
+    std::vector<std::unique_ptr<Job>> jobs_;
+    std::vector<Job*> free_;            // Libres del lado del lector
+    Job* first_ = nullptr;
+    MpmcQueue<Job*> work_;              // Lector -> trabajadores
+    SpscQueue<Job*> order_;             // Lector -> escritor, en orden de entrega
+    SpscQueue<Job*> recycled_;          // Escritor -> lector
+    Parker ready_;                      // Avisa cada trabajo procesado
+    std::atomic<bool> failed_{false};
+    std::vector<std::thread> workers_;
+    std::thread writer_;
+};
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Lugar donde se duermen los hilos que esperan una condicion. Quien la
+// cumple llama a notify: sin hilos dormidos no toma el mutex. El contador
+// de dormidos y la condicion se leen tras una barrera completa en ambos
+// lados, asi que o el que espera ve la condicion o el que avisa lo ve a el.
+class Parker {
+public:
+    template <typename Ready>
+    void wait(Ready ready) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        sleepers_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (!ready()) condition_.wait(lock);
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_relaxed) == 0) return;
+        // Tomar el mutex garantiza que el que espera ya esta en wait
+        { std::lock_guard<std::mutex> lock(mutex_); }
+        condition_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::atomic<unsigned> sleepers_{0};
+};
+
+// Espera activa que cede el procesador unas vueltas y luego se duerme en
+// el Parker hasta que le avisen: un hilo que espera datos de la red no
+// consume un nucleo ni despierta periodicamente.
+class Backoff {
+public:
+    template <typename Ready>
+    static void until(Parker& parker, Ready ready) {
+        for (int i = 0; i < YIELDS; ++i) {
+            if (ready()) return;
+            std::this_thread::yield();
+        }
+        parker.wait(ready);
+    }
+
+private:
+    static constexpr int YIELDS = 64;
+};
+
+// Capacidad de las colas: la potencia de 2 que alcanza
+inline size_t ringCapacity(size_t requested) {
+    size_t capacity = 2;
+    while (capacity < requested) capacity <<= 1;
+    return capacity;
+}
+
+// Cola acotada sin bloqueos para un productor y un consumidor (anillo de
+// Lamport): cada lado escribe solo su indice
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity) : slots_(ringCapacity(capacity)), mask_(slots_.size() - 1) {}
+
+    bool tryPush(const T& value) {
+        if (!put(value)) return false;
+        parker_.notify();
+        return true;
+    }
+
+    bool tryPop(T& value) {
+        if (!take(value)) return false;
+        parker_.notify();
+        return true;
+    }
+
+    // Bloqueantes: duermen hasta que el otro lado libere lugar o entregue
+    void push(const T& value) {
+        Backoff::until(parker_, [&]() { return put(value); });
+        parker_.notify();
+    }
+
+    T pop() {
+        T value;
+        Backoff::until(parker_, [&]() { return take(value); });
+        parker_.notify();
+        return value;
+    }
+
+private:
+    // Sin avisar: Parker::wait las evalua con su mutex tomado
+    bool put(const T& value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == slots_.size()) return false;
+        slots_[tail & mask_] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool take(T& value) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) return false;
+        value = slots_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::vector<T> slots_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+    Parker parker_;
+};
+
+// Cola acotada sin bloqueos para varios productores y consumidores
+// (Vyukov): cada celda lleva un numero de secuencia que dice si esta libre
+// para la vuelta actual del productor o lista para el consumidor
+template <typename T>
+class MpmcQueue {
+public:
+    explicit MpmcQueue(size_t capacity)
+        : mask_(ringCapacity(capacity) - 1), cells_(std::make_unique<Cell[]>(mask_ + 1)) {
+        for (size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool tryPush(const T& value) {
+        if (!put(value)) return false;
+        parker_.notify();
+        return true;
+    }
+
+    bool tryPop(T& value) {
+        if (!take(value)) return false;
+        parker_.notify();
+        return true;
+    }
+
+    // Bloqueantes: duermen hasta que el otro lado libere lugar o entregue
+    void push(const T& value) {
+        Backoff::until(parker_, [&]() { return put(value); });
+        parker_.notify();
+    }
+
+    T pop() {
+        T value;
+        Backoff::until(parker_, [&]() { return take(value); });
+        parker_.notify();
+        return value;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    // Sin avisar: Parker::wait las evalua con su mutex tomado
+    bool put(const T& value) {
+        size_t position = tail_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells_[position & mask_];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (difference == 0) {
+                if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false; // Llena
+            } else {
+                position = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool take(T& value) {
+        size_t position = head_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells_[position & mask_];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+            if (difference == 0) {
+                if (head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    value = cell.value;
+                    cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false; // Vacia
+            } else {
+                position = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+    Parker parker_;
+};
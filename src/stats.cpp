@@ -0,0 +1,112 @@
+#include "stats.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+// Grupo de contadores (ciclos y fallos de prediccion de saltos) del hilo
+// actual. Se abre la primera vez que se pide y queda abierto mientras viva
+// el hilo; si el sistema no lo permite, read devuelve false.
+class CounterGroup {
+public:
+    ~CounterGroup() {
+#ifdef __linux__
+        if (member_ >= 0) close(member_);
+        if (leader_ >= 0) close(leader_);
+#endif
+    }
+
+    bool read(uint64_t& cycles, uint64_t& branchMisses) {
+#ifdef __linux__
+        if (!opened_) open();
+        if (leader_ < 0 || member_ < 0) return false;
+
+        struct {
+            uint64_t count;
+            uint64_t values[2];
+        } data;
+        if (::read(leader_, &data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data.count != 2) {
+            return false;
+        }
+        cycles = data.values[0];
+        branchMisses = data.values[1];
+        return true;
+#else
+        (void)cycles;
+        (void)branchMisses;
+        return false;
+#endif
+    }
+
+private:
+#ifdef __linux__
+    static int openCounter(uint64_t config, int group) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = config;
+        attr.disabled = group < 0 ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group, 0));
+    }
+
+    void open() {
+        opened_ = true;
+        leader_ = openCounter(PERF_COUNT_HW_CPU_CYCLES, -1);
+        if (leader_ < 0) return;
+        member_ = openCounter(PERF_COUNT_HW_BRANCH_MISSES, leader_);
+        if (member_ < 0) return;
+        ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    int leader_ = -1;
+    int member_ = -1;
+    bool opened_ = false;
+#endif
+};
+
+static thread_local CounterGroup counters;
+
+static void add(PhaseStats& target, const PhaseStats& source) {
+    target.seconds += source.seconds;
+    target.cycles += source.cycles;
+    target.branchMisses += source.branchMisses;
+}
+
+void Stats::merge(const Stats& other) {
+    add(read, other.read);
+    add(histogram, other.histogram);
+    add(tree, other.tree);
+    add(codes, other.codes);
+    add(transform, other.transform);
+    add(encode, other.encode);
+    add(decode, other.decode);
+    add(checksum, other.checksum);
+    add(write, other.write);
+    countersUnavailable = countersUnavailable || other.countersUnavailable;
+}
+
+PhaseTimer::PhaseTimer(Stats& stats, PhaseStats& phase) : phase_(phase) {
+    if (stats.hardwareCounters) {
+        counting_ = counters.read(cycles_, branchMisses_);
+        if (!counting_) stats.countersUnavailable = true;
+    }
+    start_ = std::chrono::steady_clock::now();
+}
+
+PhaseTimer::~PhaseTimer() {
+    phase_.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    uint64_t cycles = 0;
+    uint64_t branchMisses = 0;
+    if (counting_ && counters.read(cycles, branchMisses)) {
+        phase_.cycles += cycles - cycles_;
+        phase_.branchMisses += branchMisses - branchMisses_;
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// Tiempo y contadores de hardware de una fase. Con varios hilos se suma lo
+// medido en cada uno, por lo que el total puede superar el tiempo real.
+struct PhaseStats {
+    double seconds = 0;
+    uint64_t cycles = 0;
+    uint64_t branchMisses = 0;
+};
+
+// Desglose por fase de una compresion o descompresion
+struct Stats {
+    PhaseStats read;       // Lectura de la entrada
+    PhaseStats histogram;  // Conteo de frecuencias
+    PhaseStats tree;       // Longitudes de codigo (arbol y limite de longitud)
+    PhaseStats codes;      // Codigos canonicos y tabla de longitudes / tabla de decodificacion
+    PhaseStats transform;  // Transformacion previa (BWT y move-to-front) y su inversa
+    PhaseStats encode;
+    PhaseStats decode;
+    PhaseStats checksum;   // CRC32C de los datos (calculo y verificacion)
+    PhaseStats write;      // Escritura de la salida
+
+    bool hardwareCounters = false;    // Medir ciclos y fallos de prediccion (perf_event_open)
+    bool countersUnavailable = false; // Se pidieron pero el sistema no los permite
+
+    void merge(const Stats& other);
+};
+
+// Mide una fase desde su construccion hasta su destruccion y la suma a 'phase'
+class PhaseTimer {
+public:
+    PhaseTimer(Stats& stats, PhaseStats& phase);
+    ~PhaseTimer();
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    PhaseStats& phase_;
+    std::chrono::steady_clock::time_point start_;
+    uint64_t cycles_ = 0;
+    uint64_t branchMisses_ = 0;
+    bool counting_ = false;
+};
@@ -0,0 +1,92 @@
+#include "thread_pool.hpp"
+
+thread_local const ThreadPool* ThreadPool::currentPool_ = nullptr;
+thread_local size_t ThreadPool::currentQueue_ = 0;
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0) threads = 1;
+    queues_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    workers_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        workers_.emplace_back([this, i]() { run(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    ready_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+unsigned ThreadPool::resolve(unsigned requested) {
+    if (requested > 0) return requested;
+    unsigned cores = std::thread::hardware_concurrency();
+    return cores > 0 ? cores : 1;
+}
+
+void ThreadPool::push(std::function<void()> task) {
+    size_t index = currentPool_ == this ? currentQueue_ : nextQueue_++ % queues_.size();
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+
+    // El contador se publica bajo el mutex para no perder el aviso a un
+    // hilo que esta por dormirse
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queued_++;
+    }
+    ready_.notify_one();
+}
+
+bool ThreadPool::pop(size_t self, std::function<void()>& task) {
+    // Primero la propia cola, por el final (la tarea mas reciente)
+    {
+        Queue& own = *queues_[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    // Si no, robar la tarea mas antigua de otra cola
+    for (size_t k = 1; k < queues_.size(); ++k) {
+        Queue& other = *queues_[(self + k) % queues_.size()];
+        std::lock_guard<std::mutex> lock(other.mutex);
+        if (!other.tasks.empty()) {
+            task = std::move(other.tasks.front());
+            other.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run(size_t self) {
+    currentPool_ = this;
+    currentQueue_ = self;
+
+    while (true) {
+        std::function<void()> task;
+        if (pop(self, task)) {
+            queued_--;
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.wait(lock, [this]() { return stopping_ || queued_ > 0; });
+        if (stopping_ && queued_ == 0) return;
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool de hilos de tamanio fijo con una cola por hilo y robo de tareas.
+// Las tareas encoladas desde fuera se reparten entre las colas; las que
+// encola un hilo del pool van a su propia cola. Cada hilo atiende primero
+// su cola (la tarea mas reciente) y, si esta vacia, roba la mas antigua
+// de otra, de modo que las tareas desparejas se equilibran solas.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Encola una tarea y devuelve un future con su resultado
+    template <typename F>
+    auto submit(F&& task) -> std::future<decltype(task())> {
+        using Result = decltype(task());
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> result = packaged->get_future();
+        push([packaged]() { (*packaged)(); });
+        return result;
+    }
+
+    unsigned size() const { return static_cast<unsigned>(workers_.size()); }
+
+    // Numero de hilos a usar: 0 significa todos los nucleos disponibles
+    static unsigned resolve(unsigned requested);
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void push(std::function<void()> task);
+    bool pop(size_t self, std::function<void()>& task);
+    void run(size_t self);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> nextQueue_{0};
+    std::atomic<size_t> queued_{0};
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    bool stopping_ = false;
+
+    // Pool y cola del hilo actual (nullptr fuera de los hilos de un pool)
+    static thread_local const ThreadPool* currentPool_;
+    static thread_local size_t currentQueue_;
+};
@@ -0,0 +1,110 @@
+// Pruebas de ida y vuelta de la biblioteca (ctest).
+//
+// Cada caso devuelve false y explica el fallo por stderr; el programa
+// termina con 1 si alguno fallo.
+
+#include "huffman.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Texto repetitivo con variaciones: se comprime y ocupa varios bloques
+std::vector<uint8_t> makeData(size_t size) {
+    std::vector<uint8_t> data(size);
+    uint32_t state = 12345;
+    for (size_t i = 0; i < size; ++i) {
+        state = state * 1103515245 + 12345;
+        data[i] = static_cast<uint8_t>('a' + (state >> 16) % 16);
+    }
+    return data;
+}
+
+bool expect(bool condition, const std::string& what) {
+    if (!condition) std::cerr << "FALLO: " << what << "\n";
+    return condition;
+}
+
+// CRC de la entrada y puntos de control juntos, descomprimidos con varios
+// hilos: el CRC va antes de la seccion HCPT, no justo antes del indice
+bool checksumWithCheckpoints() {
+    std::vector<uint8_t> data = makeData(5 * (size_t(64) << 10) + 123);
+    bool ok = true;
+    for (size_t interval : {size_t(1) << 10, size_t(16) << 10}) {
+        CompressOptions options;
+        options.blockSize = size_t(64) << 10;
+        options.streamChecksum = true;
+        options.checkpointInterval = interval;
+        std::vector<uint8_t> compressed;
+        if (!expect(HuffmanCompressor::compress(data.data(), data.size(), compressed, options) == Status::Ok,
+                    "comprimir con CRC y puntos de control")) {
+            return false;
+        }
+        for (unsigned threads : {1u, 2u, 3u, 4u}) {
+            DecompressOptions decompressOptions;
+            decompressOptions.threads = threads;
+            std::vector<uint8_t> restored;
+            Status status = HuffmanCompressor::decompress(compressed.data(), compressed.size(), restored,
+                                                          decompressOptions);
+            ok &= expect(status == Status::Ok && restored == data,
+                         "ida y vuelta con CRC, intervalo " + std::to_string(interval) + " y " +
+                             std::to_string(threads) + " hilos: " + statusMessage(status));
+        }
+    }
+    return ok;
+}
+
+void writeFile(const fs::path& path, const std::string& text) {
+    fs::create_directories(path.parent_path());
+    std::ofstream(path, std::ios::binary) << text;
+}
+
+// Dos archivos distintos que se guardarian con el mismo nombre ("../a/x.txt"
+// y "../b/x.txt" quedan como "x.txt") no se descartan en silencio; la misma
+// ruta nombrada dos veces si se guarda una sola vez
+bool archiveDuplicateNames() {
+    fs::path base = fs::temp_directory_path() / "huffman_tests_archive";
+    fs::remove_all(base);
+    writeFile(base / "a" / "x.txt", "primero");
+    writeFile(base / "b" / "x.txt", "segundo");
+    fs::create_directories(base / "trabajo");
+    fs::path previous = fs::current_path();
+    fs::current_path(base / "trabajo");
+
+    bool ok = true;
+    std::pair<std::string, std::string> duplicate;
+    Status status = HuffmanCompressor::createArchive({"../a/x.txt", "../b/x.txt"}, "t.HUBA", CompressOptions{},
+                                                     nullptr, &duplicate);
+    ok &= expect(status == Status::DuplicateMember, std::string("nombres repetidos: ") + statusMessage(status));
+    ok &= expect(duplicate.first == "../a/x.txt" && duplicate.second == "../b/x.txt",
+                 "rutas del nombre repetido: " + duplicate.first + ", " + duplicate.second);
+
+    status = HuffmanCompressor::createArchive({"../a/x.txt", "../a/./x.txt", "../a/x.txt"}, "t.HUBA");
+    {
+        HuffmanCompressor::ArchiveReader reader;
+        ok &= expect(status == Status::Ok && reader.open("t.HUBA") == Status::Ok && reader.entries().size() == 1,
+                     std::string("misma ruta repetida: ") + statusMessage(status));
+    }
+
+    fs::current_path(previous);
+    fs::remove_all(base);
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    bool ok = true;
+    ok &= checksumWithCheckpoints();
+    ok &= archiveDuplicateNames();
+    if (ok) std::puts("Todas las pruebas pasaron");
+    return ok ? 0 : 1;
+}